@@ -14,6 +14,14 @@
 #define LED_EFFECTS_UPDATE_INTERVAL_MS    4
 #endif
 
+// <o LED_EFFECTS_DITHER_INTERVAL_MS> LED dithering interval (ms)
+// <i> Frame interval for colors between two 8-bit levels. LEDs dither out of phase,
+// <i> so this can be slower than the update interval without visible flicker.
+// <d> 8
+#ifndef LED_EFFECTS_DITHER_INTERVAL_MS
+#define LED_EFFECTS_DITHER_INTERVAL_MS    8
+#endif
+
 // <o LED_EFFECTS_TILT_THRESHOLD_DEG> Tilt threshold (degrees)
 // <i> Angle threshold to trigger tilt detection
 // <d> 16
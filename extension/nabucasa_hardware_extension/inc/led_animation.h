@@ -0,0 +1,90 @@
+/*
+ * led_animation.h
+ *
+ * Keyframe animations, run by the LED manager priority layers
+ */
+
+#ifndef LED_ANIMATION_H
+#define LED_ANIMATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Longest animation that can be uploaded by a host
+#define LED_ANIMATION_MAX_STEPS      32
+
+// Loops can be nested this deep
+#define LED_ANIMATION_MAX_LOOP_DEPTH 4
+
+// `duration_ms` of a loop step that repeats forever
+#define LED_ANIMATION_LOOP_FOREVER   0xFFFF
+
+typedef enum {
+    LED_KEYFRAME_HOLD = 0,     // Show `color` for `duration_ms`
+    LED_KEYFRAME_FADE,         // Fade from the previous color to `color`, eased by `arg`
+    LED_KEYFRAME_TRANSPARENT,  // Show the layers below for `duration_ms`
+    LED_KEYFRAME_LOOP,         // Go back to step `arg`, `duration_ms` more times
+} led_keyframe_op_t;
+
+typedef enum {
+    LED_EASING_LINEAR = 0,
+    LED_EASING_IN,             // Quadratic
+    LED_EASING_OUT,            // Quadratic
+    LED_EASING_IN_OUT,         // Smoothstep
+    LED_EASING_COUNT
+} led_easing_t;
+
+typedef struct {
+    uint8_t op;                // led_keyframe_op_t
+    uint8_t arg;
+    uint16_t duration_ms;
+    uint16_t color[3];         // Red, green, blue
+} led_keyframe_t;
+
+typedef enum {
+    LED_ANIMATION_COLOR,       // The layer shows a color
+    LED_ANIMATION_TRANSPARENT, // The layers below show through
+    LED_ANIMATION_DONE,        // The last step has ended
+} led_animation_state_t;
+
+typedef struct {
+    const led_keyframe_t *steps;
+    uint8_t step_count;
+    uint8_t step;
+    uint32_t step_start_ms;
+    uint16_t from[3];          // Color at the start of the current step
+
+    uint8_t loop_depth;
+    struct {
+        uint8_t step;
+        uint16_t remaining;
+    } loops[LED_ANIMATION_MAX_LOOP_DEPTH];
+} led_animation_t;
+
+/**
+ * @brief Check that steps are well formed
+ * Loops must jump backwards and their body must take time, so an animation can
+ * never spin without making progress.
+ */
+bool led_animation_validate(const led_keyframe_t *steps, uint8_t step_count);
+
+/**
+ * @brief Start an animation, `steps` must stay valid while it runs
+ */
+void led_animation_start(led_animation_t *animation,
+                         const led_keyframe_t *steps,
+                         uint8_t step_count,
+                         uint32_t now_ms);
+
+/**
+ * @brief Advance an animation to `now_ms`
+ * @param color Set to the color to show for LED_ANIMATION_COLOR
+ * @param next_update_ms Set to the time until the output next changes, 0 while
+ *                       fading
+ */
+led_animation_state_t led_animation_update(led_animation_t *animation,
+                                           uint32_t now_ms,
+                                           uint16_t color[3],
+                                           uint32_t *next_update_ms);
+
+#endif // LED_ANIMATION_H
@@ -23,6 +23,13 @@ void led_effects_init(void);
  */
 void led_effects_set_network_state(bool network_formed);
 
+/**
+ * @brief Check whether the device is currently tilted
+ * Only tracked while the tilt monitor runs, i.e. until a network is formed.
+ * @return true if tilted, false otherwise
+ */
+bool led_effects_is_tilted(void);
+
 /**
  * @brief Check if device has valid stored network configuration
  * Implemented by the application (Router/NCP/OT)
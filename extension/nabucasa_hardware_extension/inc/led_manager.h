@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "led_manager_colors.h"
+#include "led_waveform.h"
+#include "led_animation.h"
 
 // Priorities for LED control (Higher value = Higher priority)
 typedef enum {
@@ -19,7 +21,9 @@ typedef enum {
     LED_MODE_OFF = 0,
     LED_MODE_STATIC,    // Constant color
     LED_MODE_BLINK,     // On/Off square wave
-    LED_MODE_PULSE,     // Triangle wave fading
+    LED_MODE_PULSE,     // Fading, shaped by `waveform`
+    LED_MODE_PIXELS,    // Per-LED colors, see led_manager_set_pixels()
+    LED_MODE_ANIMATION, // Keyframes, see led_manager_play_animation()
 } led_mode_t;
 
 typedef struct {
@@ -29,8 +33,12 @@ typedef struct {
     uint32_t duration_ms;    // Auto-clear after this time (0 = infinite)
     uint16_t brightness_min; // Min brightness for pulse (0-65535)
     uint16_t brightness_max; // Max brightness for pulse (0-65535)
+    led_waveform_t waveform; // Pulse shape, triangle by default
 } led_pattern_t;
 
+// Called when an animation has played its last step
+typedef void (*led_animation_done_t)(led_priority_t priority);
+
 /**
  * @brief Initialize the LED manager
  */
@@ -38,10 +46,20 @@ void led_manager_init(void);
 
 /**
  * @brief Main loop process action handler
- * Handles LED updates safely outside of interrupt context.
+ * Handles LED updates safely outside of interrupt context. A one-shot timer is
+ * only armed for the next blink edge, pulse step or pattern expiry, a static
+ * color keeps no timer running.
  */
 void led_manager_process_action(void);
 
+/**
+ * @brief Power manager hook
+ * Keeps the device awake while a pattern change has not been rendered yet, e.g.
+ * when it was made by a handler that ran after the process action.
+ * @return false while an update is pending
+ */
+bool led_manager_is_ok_to_sleep(void);
+
 /**
  * @brief Set a pattern for a specific priority layer
  * @param priority The priority layer to set
@@ -55,6 +73,39 @@ void led_manager_set_pattern(led_priority_t priority, const led_pattern_t *patte
  */
 void led_manager_clear_pattern(led_priority_t priority);
 
+/**
+ * @brief Play a keyframe animation on a layer
+ * Animations on all layers share the LED manager timer. The layer is cleared
+ * once the last step has ended and `on_done` is called, but not if the layer is
+ * set or cleared before that.
+ * @param priority The priority layer to set
+ * @param steps Keyframes, must stay valid while the animation runs
+ * @param step_count Number of keyframes
+ * @param on_done Called from the LED update context, may be NULL
+ * @return false if the keyframes are not valid
+ */
+bool led_manager_play_animation(led_priority_t priority,
+                                const led_keyframe_t *steps,
+                                uint8_t step_count,
+                                led_animation_done_t on_done);
+
+/**
+ * @brief Set the colors of individual LEDs on a layer
+ * Switches the layer to LED_MODE_PIXELS. LEDs outside of the range keep their
+ * color if the layer already was in that mode, otherwise they are black.
+ * @param priority The priority layer to set
+ * @param first Index of the first LED to set
+ * @param colors Colors of LEDs `first` to `first + count - 1`
+ * @param count Number of colors
+ * @return false if the range does not fit the number of LEDs
+ */
+bool led_manager_set_pixels(led_priority_t priority, uint8_t first, const rgb_t *colors, uint8_t count);
+
+/**
+ * @brief Number of individually addressable LEDs
+ */
+uint8_t led_manager_get_pixel_count(void);
+
 /**
  * @brief Helper to set a static color on a layer
  */
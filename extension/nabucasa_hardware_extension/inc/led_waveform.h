@@ -0,0 +1,62 @@
+/*
+ * led_waveform.h
+ *
+ * Precomputed brightness envelopes for LED animations
+ */
+
+#ifndef LED_WAVEFORM_H
+#define LED_WAVEFORM_H
+
+#include <stdint.h>
+
+// Envelope shapes, all rise over the first half of the period and fall over the second
+typedef enum {
+    LED_WAVEFORM_TRIANGLE = 0,  // Linear ramps
+    LED_WAVEFORM_SINE,          // Raised cosine
+    LED_WAVEFORM_BREATHE,       // exp(sin), lingers near the minimum
+} led_waveform_t;
+
+// Samples of the rising half, the falling half is mirrored. Must be a power of two.
+#define LED_WAVEFORM_SAMPLES 64
+
+typedef struct {
+    uint16_t levels[LED_WAVEFORM_SAMPLES];  // Gamma corrected brightness
+    uint32_t step;                          // Samples per ms, Q16
+    uint16_t sample_ms;                     // Time between samples
+} led_envelope_t;
+
+/**
+ * @brief Precompute the envelope of a pattern
+ * Levels go from `min` to `max` in perceived brightness, so both ends are linear
+ * output levels as used by the LED driver.
+ */
+void led_envelope_init(led_envelope_t *envelope,
+                       led_waveform_t waveform,
+                       uint16_t period_ms,
+                       uint16_t min,
+                       uint16_t max);
+
+/**
+ * @brief Brightness `elapsed_ms` into the pattern, 0-65535
+ */
+static inline uint16_t led_envelope_level(const led_envelope_t *envelope, uint32_t elapsed_ms)
+{
+    uint32_t position = (uint32_t)(((uint64_t)elapsed_ms * envelope->step) >> 16)
+                        & ((2 * LED_WAVEFORM_SAMPLES) - 1);
+
+    if (position >= LED_WAVEFORM_SAMPLES) {
+        position = ((2 * LED_WAVEFORM_SAMPLES) - 1) - position;
+    }
+
+    return envelope->levels[position];
+}
+
+/**
+ * @brief Scale a color channel by a brightness level, 65535 keeps it unchanged
+ */
+static inline uint16_t led_scale(uint16_t value, uint16_t level)
+{
+    return (uint16_t)(((uint32_t)value * ((uint32_t)level + 1)) >> 16);
+}
+
+#endif // LED_WAVEFORM_H
@@ -9,6 +9,7 @@
 #define WS2812_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "sl_led.h"
 #include "sl_simple_rgb_pwm_led.h"
@@ -18,11 +19,31 @@ void ws2812_led_driver_init(void);
 
 /**
  * @brief Refresh the LED hardware
- * Performs dithering and blasts the current color state to the LEDs.
- * Safe to call from ISR.
+ * Performs dithering and encodes the current color state into a free frame
+ * buffer, which is sent right away or as soon as the frame in flight is done.
+ * The frame in flight is never modified. Without changes or dithering nothing
+ * is sent. Encoding runs in the caller's context, so call this from the main
+ * loop and from one context only.
  */
 void ws2812_led_driver_refresh(void);
 
+/**
+ * @brief Set the color of a single LED
+ * Takes effect on the next refresh. Only changed LEDs are encoded again, so
+ * setting a pixel to its current color costs nothing. `sl_led_ws2812` sets all
+ * LEDs at once.
+ * @param index LED index, below WS2812_NUM_LEDS
+ */
+void ws2812_led_driver_set_pixel(uint8_t index, uint16_t red, uint16_t green, uint16_t blue);
+
+/**
+ * @brief Check whether any LED color lies between two 8-bit levels
+ * Such colors are only reproduced if refresh is called continuously, every call
+ * outputs the next dithering frame. The LEDs dither out of phase, which keeps
+ * the flicker low at a modest, steady rate.
+ */
+bool ws2812_led_driver_needs_dither(void);
+
 extern const sl_led_rgb_pwm_t sl_led_ws2812;
 
 #endif /* WS2812_H_ */
@@ -0,0 +1,192 @@
+/*
+ * led_animation.c
+ *
+ * Keyframe animations, run by the LED manager priority layers
+ *
+ * An animation is a list of steps that each show a color, fade to one or let the
+ * layers below show through, plus loop steps that jump back. Only the position in
+ * the list is kept, so every update is a few comparisons, and a multiply per channel
+ * while fading.
+ */
+
+#include "led_animation.h"
+#include <string.h>
+
+// Progress through a step, Q16
+static uint32_t ease(uint8_t easing, uint32_t t)
+{
+    switch (easing) {
+        case LED_EASING_IN:
+            return (t * t) >> 16;
+
+        case LED_EASING_OUT: {
+            uint64_t u = 65536 - t;
+            return 65536 - (uint32_t)((u * u) >> 16);
+        }
+
+        case LED_EASING_IN_OUT: {
+            uint64_t t2 = (t * t) >> 16;
+            return (uint32_t)((t2 * ((3 * 65536) - (2 * t))) >> 16);
+        }
+
+        case LED_EASING_LINEAR:
+        default:
+            return t;
+    }
+}
+
+// Follows loop steps starting at `step`, returns the next step that takes time, or
+// `step_count` at the end
+static uint8_t resolve_loops(led_animation_t *animation, uint8_t step)
+{
+    while ((step < animation->step_count) && (animation->steps[step].op == LED_KEYFRAME_LOOP)) {
+        const led_keyframe_t *loop = &animation->steps[step];
+
+        if (loop->duration_ms == LED_ANIMATION_LOOP_FOREVER) {
+            step = loop->arg;
+            continue;
+        }
+
+        // Entering the loop for the first time
+        if ((animation->loop_depth == 0)
+            || (animation->loops[animation->loop_depth - 1].step != step)) {
+            // Too deeply nested, the body just plays once
+            if (animation->loop_depth == LED_ANIMATION_MAX_LOOP_DEPTH) {
+                step++;
+                continue;
+            }
+
+            animation->loops[animation->loop_depth].step = step;
+            animation->loops[animation->loop_depth].remaining = loop->duration_ms;
+            animation->loop_depth++;
+        }
+
+        if (animation->loops[animation->loop_depth - 1].remaining == 0) {
+            animation->loop_depth--;
+            step++;
+        } else {
+            animation->loops[animation->loop_depth - 1].remaining--;
+            step = loop->arg;
+        }
+    }
+
+    return step;
+}
+
+bool led_animation_validate(const led_keyframe_t *steps, uint8_t step_count)
+{
+    if ((step_count == 0) || (step_count > LED_ANIMATION_MAX_STEPS)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < step_count; i++) {
+        const led_keyframe_t *step = &steps[i];
+
+        switch (step->op) {
+            case LED_KEYFRAME_HOLD:
+            case LED_KEYFRAME_TRANSPARENT:
+                break;
+
+            case LED_KEYFRAME_FADE:
+                if (step->arg >= LED_EASING_COUNT) {
+                    return false;
+                }
+                break;
+
+            case LED_KEYFRAME_LOOP: {
+                bool takes_time = false;
+
+                if (step->arg >= i) {
+                    return false;
+                }
+
+                for (uint8_t j = step->arg; j < i; j++) {
+                    if ((steps[j].op != LED_KEYFRAME_LOOP) && (steps[j].duration_ms > 0)) {
+                        takes_time = true;
+                    }
+                }
+
+                if (!takes_time) {
+                    return false;
+                }
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void led_animation_start(led_animation_t *animation,
+                         const led_keyframe_t *steps,
+                         uint8_t step_count,
+                         uint32_t now_ms)
+{
+    memset(animation, 0, sizeof(*animation));
+
+    animation->steps = steps;
+    animation->step_count = step_count;
+    animation->step_start_ms = now_ms;
+    animation->step = resolve_loops(animation, 0);
+}
+
+led_animation_state_t led_animation_update(led_animation_t *animation,
+                                           uint32_t now_ms,
+                                           uint16_t color[3],
+                                           uint32_t *next_update_ms)
+{
+    const led_keyframe_t *step;
+
+    // Catch up on the steps that ended since the last update
+    while (animation->step < animation->step_count) {
+        step = &animation->steps[animation->step];
+
+        if ((now_ms - animation->step_start_ms) < step->duration_ms) {
+            break;
+        }
+
+        if (step->op == LED_KEYFRAME_TRANSPARENT) {
+            memset(animation->from, 0, sizeof(animation->from));
+        } else {
+            memcpy(animation->from, step->color, sizeof(animation->from));
+        }
+
+        animation->step_start_ms += step->duration_ms;
+        animation->step = resolve_loops(animation, animation->step + 1);
+    }
+
+    if (animation->step >= animation->step_count) {
+        return LED_ANIMATION_DONE;
+    }
+
+    step = &animation->steps[animation->step];
+
+    uint32_t elapsed_ms = now_ms - animation->step_start_ms;
+    *next_update_ms = step->duration_ms - elapsed_ms;
+
+    switch (step->op) {
+        case LED_KEYFRAME_TRANSPARENT:
+            return LED_ANIMATION_TRANSPARENT;
+
+        case LED_KEYFRAME_FADE: {
+            uint32_t progress = ease(step->arg, (elapsed_ms << 16) / step->duration_ms);
+
+            for (int i = 0; i < 3; i++) {
+                int32_t delta = (int32_t)step->color[i] - animation->from[i];
+                color[i] = (uint16_t)(animation->from[i] + (((int64_t)delta * progress) >> 16));
+            }
+
+            // The color changes continuously
+            *next_update_ms = 0;
+            return LED_ANIMATION_COLOR;
+        }
+
+        case LED_KEYFRAME_HOLD:
+        default:
+            memcpy(color, step->color, sizeof(step->color));
+            return LED_ANIMATION_COLOR;
+    }
+}
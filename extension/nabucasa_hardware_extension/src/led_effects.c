@@ -21,8 +21,8 @@
 // Internal state
 static sl_sleeptimer_timer_handle_t tilt_monitor_timer;
 static uint32_t monitor_ticks = 0;
-static bool is_monitoring = false;
-static bool was_tilted = false;
+static volatile bool is_monitoring = false;
+static volatile bool was_tilted = false;
 
 // Calculate tilt angle from accelerometer data
 static float calculate_tilt_angle(void)
@@ -85,6 +85,11 @@ void led_effects_init(void)
   led_manager_init();
 }
 
+bool led_effects_is_tilted(void)
+{
+  return is_monitoring && was_tilted;
+}
+
 void led_effects_set_network_state(bool network_formed)
 {
     if (network_formed) {
@@ -10,143 +10,345 @@
 typedef struct {
     led_pattern_t pattern;
     bool active;
-    uint32_t start_tick;
-    uint32_t expiry_tick;
+    uint32_t start_ms;
+    uint32_t expiry_ms;
+    rgb_t pixels[WS2812_NUM_LEDS];  // LED_MODE_PIXELS colors
+    led_envelope_t envelope;        // LED_MODE_PULSE brightness
+    led_animation_t animation;      // LED_MODE_ANIMATION position
+    led_animation_done_t on_done;
+    uint16_t animation_color[3];
 } led_layer_state_t;
 
+// The output does not change again until the next pattern change
+#define LED_NO_DEADLINE UINT32_MAX
+
 static led_layer_state_t layers[LED_PRIORITY_COUNT];
 static sl_sleeptimer_timer_handle_t led_timer;
-static volatile uint32_t global_tick_counter = 0;
 static volatile bool update_needed = false;
 static bool manager_initialized = false;
 
-static void update_led_hardware(void) {
+// Done callbacks of animations that ended during the last update
+static led_animation_done_t finished_animations[LED_PRIORITY_COUNT];
+
+static uint32_t current_ms(void) {
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint32_t)ms;
+}
+
+static uint32_t min_u32(uint32_t a, uint32_t b) {
+    return (a < b) ? a : b;
+}
+
+// Called after an update, the callbacks may set new patterns
+static void notify_finished_animations(void) {
+    for (int i = 0; i < LED_PRIORITY_COUNT; i++) {
+        led_animation_done_t on_done = finished_animations[i];
+
+        if (on_done != NULL) {
+            finished_animations[i] = NULL;
+            on_done((led_priority_t)i);
+        }
+    }
+}
+
+// What the LEDs show, resolved from the layers
+typedef struct {
+    bool on;
+    bool per_pixel;
+    uint16_t color[3];
+    rgb_t pixels[WS2812_NUM_LEDS];
+} led_output_t;
+
+// Advances every layer and resolves the visible one into `output`. Returns the time
+// in ms until the output next changes.
+static uint32_t resolve_output(uint32_t now, led_output_t *output) {
     int top_layer = -1;
-    uint32_t current_tick = global_tick_counter;
+    uint32_t next_update_ms = LED_NO_DEADLINE;
+
+    output->on = false;
+    output->per_pixel = false;
 
     // Check for expirations and find highest active layer
     for (int i = LED_PRIORITY_COUNT - 1; i >= 0; i--) {
         if (layers[i].active) {
             // Handle auto-expiry for NOTIFICATION or other timed layers
-            if (layers[i].pattern.duration_ms > 0 && current_tick >= layers[i].expiry_tick) {
-                layers[i].active = false;
-                continue;
+            if (layers[i].pattern.duration_ms > 0) {
+                int32_t remaining_ms = (int32_t)(layers[i].expiry_ms - now);
+
+                if (remaining_ms <= 0) {
+                    layers[i].active = false;
+                    continue;
+                }
+
+                next_update_ms = min_u32(next_update_ms, (uint32_t)remaining_ms);
             }
+
+            // Animations advance even while hidden, so they end on time
+            if (layers[i].pattern.mode == LED_MODE_ANIMATION) {
+                uint32_t animation_next_ms = 0;
+                led_animation_state_t state = led_animation_update(&layers[i].animation,
+                                                                   now,
+                                                                   layers[i].animation_color,
+                                                                   &animation_next_ms);
+
+                if (state == LED_ANIMATION_DONE) {
+                    layers[i].active = false;
+                    finished_animations[i] = layers[i].on_done;
+                    continue;
+                }
+
+                // Fades are redrawn at the update interval
+                if (animation_next_ms < LED_EFFECTS_UPDATE_INTERVAL_MS) {
+                    animation_next_ms = LED_EFFECTS_UPDATE_INTERVAL_MS;
+                }
+                next_update_ms = min_u32(next_update_ms, animation_next_ms);
+
+                if (state == LED_ANIMATION_TRANSPARENT) {
+                    continue;
+                }
+            }
+
             if (top_layer == -1) {
                 top_layer = i;
             }
         }
     }
 
-
+    // Hidden animations still need their next step, so keep their deadline
     if (top_layer == -1) {
-        sl_led_turn_off(&sl_led_ws2812.led_common);
-        return;
+        return next_update_ms;
     }
 
     led_layer_state_t *l = &layers[top_layer];
     led_pattern_t *p = &l->pattern;
-    uint32_t layer_ticks = current_tick - l->start_tick;
-    uint32_t ms_elapsed = layer_ticks * LED_EFFECTS_UPDATE_INTERVAL_MS;
+    uint32_t ms_elapsed = now - l->start_ms;
 
     switch (p->mode) {
         case LED_MODE_OFF:
-            sl_led_turn_off(&sl_led_ws2812.led_common);
             break;
 
         case LED_MODE_STATIC:
-            sl_led_set_rgb_color(&sl_led_ws2812, p->color.r, p->color.g, p->color.b);
-            sl_led_turn_on(&sl_led_ws2812.led_common);
+            output->on = true;
+            output->color[0] = p->color.r;
+            output->color[1] = p->color.g;
+            output->color[2] = p->color.b;
+            break;
+
+        case LED_MODE_ANIMATION:
+            output->on = true;
+            memcpy(output->color, l->animation_color, sizeof(output->color));
+            break;
+
+        case LED_MODE_PIXELS:
+            output->on = true;
+            output->per_pixel = true;
+            memcpy(output->pixels, l->pixels, sizeof(output->pixels));
             break;
 
         case LED_MODE_BLINK: {
             uint32_t period = (p->period_ms > 0) ? p->period_ms : 500;
-            bool on = (ms_elapsed % period) < (period / 2);
-            if (on) {
-                sl_led_set_rgb_color(&sl_led_ws2812, p->color.r, p->color.g, p->color.b);
-                sl_led_turn_on(&sl_led_ws2812.led_common);
+            uint32_t phase = ms_elapsed % period;
+            output->on = phase < (period / 2);
+            if (output->on) {
+                output->color[0] = p->color.r;
+                output->color[1] = p->color.g;
+                output->color[2] = p->color.b;
+                next_update_ms = min_u32(next_update_ms, (period / 2) - phase);
             } else {
-                sl_led_turn_off(&sl_led_ws2812.led_common);
+                next_update_ms = min_u32(next_update_ms, period - phase);
             }
             break;
         }
 
         case LED_MODE_PULSE: {
-            uint32_t period = (p->period_ms >= 2) ? p->period_ms : 1000;
-            uint32_t half_period = period / 2;
-            uint32_t phase = ms_elapsed % period;
+            // Envelope precomputed by led_manager_set_pattern()
+            uint16_t brightness = led_envelope_level(&l->envelope, ms_elapsed);
 
-            uint32_t brightness;
-            if (phase < half_period) {
-                brightness = (phase * 65535) / half_period;
-            } else {
-                brightness = 65535 - ((phase - half_period) * 65535) / (period - half_period);
+            output->on = true;
+            output->color[0] = led_scale(p->color.r, brightness);
+            output->color[1] = led_scale(p->color.g, brightness);
+            output->color[2] = led_scale(p->color.b, brightness);
+            // No point in waking up before the envelope moves on to its next sample
+            uint32_t step_ms = l->envelope.sample_ms;
+            if (step_ms < LED_EFFECTS_UPDATE_INTERVAL_MS) {
+                step_ms = LED_EFFECTS_UPDATE_INTERVAL_MS;
             }
+            next_update_ms = min_u32(next_update_ms, step_ms);
+            break;
+        }
+    }
 
-            uint32_t min_b = p->brightness_min;
-            uint32_t max_b = p->brightness_max;
-            brightness = min_b + ((max_b - min_b) * brightness / 65535);
+    return next_update_ms;
+}
 
-            uint16_t r = ((uint32_t)p->color.r * brightness) / 65535;
-            uint16_t g = ((uint32_t)p->color.g * brightness) / 65535;
-            uint16_t b = ((uint32_t)p->color.b * brightness) / 65535;
+// Renders the current state and returns the time in ms until it next changes
+static uint32_t update_led_hardware(void) {
+    led_output_t output;
 
-            sl_led_set_rgb_color(&sl_led_ws2812, r, g, b);
-            sl_led_turn_on(&sl_led_ws2812.led_common);
-            break;
+    // Layers are also set and cleared from interrupt context (the reset button), so
+    // they are only read and advanced with interrupts masked. Driving the LEDs can
+    // take a while and happens afterwards.
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    uint32_t next_update_ms = resolve_output(current_ms(), &output);
+    CORE_EXIT_CRITICAL();
+
+    if (!output.on) {
+        sl_led_turn_off(&sl_led_ws2812.led_common);
+    } else if (output.per_pixel) {
+        for (uint8_t i = 0; i < WS2812_NUM_LEDS; i++) {
+            ws2812_led_driver_set_pixel(i, output.pixels[i].r, output.pixels[i].g, output.pixels[i].b);
         }
+        sl_led_turn_on(&sl_led_ws2812.led_common);
+    } else {
+        sl_led_set_rgb_color(&sl_led_ws2812, output.color[0], output.color[1], output.color[2]);
+        sl_led_turn_on(&sl_led_ws2812.led_common);
+    }
+
+    ws2812_led_driver_refresh();
+
+    // Colors between two 8-bit levels need a new dithering frame at a steady rate
+    if (ws2812_led_driver_needs_dither()) {
+        next_update_ms = min_u32(next_update_ms, LED_EFFECTS_DITHER_INTERVAL_MS);
     }
+
+    return next_update_ms;
 }
 
 static void led_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data) {
     (void)handle;
     (void)data;
-    global_tick_counter++;
     update_needed = true;
-    ws2812_led_driver_refresh();
 }
 
 void led_manager_init(void) {
     if (manager_initialized) return;
 
     memset(layers, 0, sizeof(layers));
-    
-    sl_sleeptimer_start_periodic_timer_ms(&led_timer,
-                                          LED_EFFECTS_UPDATE_INTERVAL_MS,
-                                          led_timer_callback,
-                                          NULL,
-                                          0,
-                                          0);
+
+    // Nothing runs until the first update, which turns the LED off
+    update_needed = true;
     manager_initialized = true;
 }
 
 void led_manager_process_action(void) {
-    if (update_needed) {
-        update_needed = false;
-        update_led_hardware();
+    if (!update_needed) return;
+    update_needed = false;
+
+    uint32_t next_update_ms = update_led_hardware();
+    notify_finished_animations();
+
+    // Static output needs no timer at all, so the device is free to sleep
+    if (next_update_ms == LED_NO_DEADLINE) {
+        sl_sleeptimer_stop_timer(&led_timer);
+    } else {
+        sl_sleeptimer_restart_timer_ms(&led_timer,
+                                       next_update_ms,
+                                       led_timer_callback,
+                                       NULL,
+                                       0,
+                                       0);
     }
 }
 
+bool led_manager_is_ok_to_sleep(void) {
+    return !update_needed;
+}
+
 void led_manager_set_pattern(led_priority_t priority, const led_pattern_t *pattern) {
     if (priority >= LED_PRIORITY_COUNT) return;
 
+    // Computed up front, it is too slow for a critical section
+    led_envelope_t envelope;
+    if (pattern->mode == LED_MODE_PULSE) {
+        uint16_t period = (pattern->period_ms >= 2) ? pattern->period_ms : 1000;
+        led_envelope_init(&envelope, pattern->waveform, period,
+                          pattern->brightness_min, pattern->brightness_max);
+    }
+
     CORE_DECLARE_IRQ_STATE;
     CORE_ENTER_CRITICAL();
 
     layers[priority].pattern = *pattern;
+    if (pattern->mode == LED_MODE_PULSE) {
+        layers[priority].envelope = envelope;
+    }
     layers[priority].active = true;
-    layers[priority].start_tick = global_tick_counter;
-    
+    layers[priority].start_ms = current_ms();
+
     if (pattern->duration_ms > 0) {
-        layers[priority].expiry_tick = global_tick_counter + (pattern->duration_ms / LED_EFFECTS_UPDATE_INTERVAL_MS);
+        layers[priority].expiry_ms = layers[priority].start_ms + pattern->duration_ms;
     }
 
+    update_needed = true;
+
     CORE_EXIT_CRITICAL();
 }
 
 void led_manager_clear_pattern(led_priority_t priority) {
     if (priority >= LED_PRIORITY_COUNT) return;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+
     layers[priority].active = false;
+    update_needed = true;
+
+    CORE_EXIT_CRITICAL();
+}
+
+bool led_manager_play_animation(led_priority_t priority,
+                                const led_keyframe_t *steps,
+                                uint8_t step_count,
+                                led_animation_done_t on_done) {
+    if (priority >= LED_PRIORITY_COUNT) return false;
+    if (!led_animation_validate(steps, step_count)) return false;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+
+    led_layer_state_t *l = &layers[priority];
+
+    memset(&l->pattern, 0, sizeof(l->pattern));
+    l->pattern.mode = LED_MODE_ANIMATION;
+    l->active = true;
+    l->start_ms = current_ms();
+    l->on_done = on_done;
+    led_animation_start(&l->animation, steps, step_count, l->start_ms);
+    update_needed = true;
+
+    CORE_EXIT_CRITICAL();
+    return true;
+}
+
+bool led_manager_set_pixels(led_priority_t priority, uint8_t first, const rgb_t *colors, uint8_t count) {
+    if (priority >= LED_PRIORITY_COUNT) return false;
+    if (first >= WS2812_NUM_LEDS || count > WS2812_NUM_LEDS - first) return false;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+
+    led_layer_state_t *l = &layers[priority];
+
+    // LEDs that are not set start out black
+    if (!l->active || l->pattern.mode != LED_MODE_PIXELS) {
+        memset(l->pixels, 0, sizeof(l->pixels));
+        memset(&l->pattern, 0, sizeof(l->pattern));
+        l->pattern.mode = LED_MODE_PIXELS;
+        l->active = true;
+        l->start_ms = current_ms();
+    }
+
+    memcpy(&l->pixels[first], colors, count * sizeof(rgb_t));
+    update_needed = true;
+
+    CORE_EXIT_CRITICAL();
+    return true;
+}
+
+uint8_t led_manager_get_pixel_count(void) {
+    return WS2812_NUM_LEDS;
 }
 
 void led_manager_set_color(led_priority_t priority, rgb_t color) {
@@ -0,0 +1,61 @@
+/*
+ * led_waveform.c
+ *
+ * Precomputed brightness envelopes for LED animations
+ *
+ * Envelopes are computed once when a pattern is set, so every animation frame only
+ * costs a table lookup and a multiply per channel, whatever the shape.
+ */
+
+#include "led_waveform.h"
+#include <math.h>
+
+// Perceived brightness is roughly linear in output^(1/gamma)
+#define LED_WAVEFORM_GAMMA 2.2f
+
+#define PI_F 3.14159265f
+#define E_F  2.71828183f
+
+#if (LED_WAVEFORM_SAMPLES & (LED_WAVEFORM_SAMPLES - 1)) != 0
+#error "LED_WAVEFORM_SAMPLES must be a power of two"
+#endif
+
+// Shape of the rising half, `x` from 0 to 1
+static float waveform_shape(led_waveform_t waveform, float x)
+{
+    switch (waveform) {
+        case LED_WAVEFORM_SINE:
+            return (1.0f - cosf(PI_F * x)) / 2.0f;
+
+        case LED_WAVEFORM_BREATHE:
+            return (expf(-cosf(PI_F * x)) - (1.0f / E_F)) / (E_F - (1.0f / E_F));
+
+        case LED_WAVEFORM_TRIANGLE:
+        default:
+            return x;
+    }
+}
+
+void led_envelope_init(led_envelope_t *envelope,
+                       led_waveform_t waveform,
+                       uint16_t period_ms,
+                       uint16_t min,
+                       uint16_t max)
+{
+    float low = powf(min / 65535.0f, 1.0f / LED_WAVEFORM_GAMMA);
+    float high = powf(max / 65535.0f, 1.0f / LED_WAVEFORM_GAMMA);
+
+    for (int i = 0; i < LED_WAVEFORM_SAMPLES; i++) {
+        float shape = waveform_shape(waveform, (float)i / (LED_WAVEFORM_SAMPLES - 1));
+        float level = powf(low + ((high - low) * shape), LED_WAVEFORM_GAMMA);
+
+        envelope->levels[i] = (uint16_t)((level * 65535.0f) + 0.5f);
+    }
+
+    if (period_ms == 0) {
+        period_ms = 1;
+    }
+
+    envelope->step = ((uint32_t)(2 * LED_WAVEFORM_SAMPLES) << 16) / period_ms;
+    envelope->sample_ms = period_ms / (2 * LED_WAVEFORM_SAMPLES);
+}
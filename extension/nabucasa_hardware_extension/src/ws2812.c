@@ -8,6 +8,7 @@
 
 #include "ws2812.h"
 #include <string.h>
+#include "em_core.h"
 #include "em_gpio.h"
 #include "sl_spidrv_instances.h"
 
@@ -36,9 +37,27 @@
 #define WS2812_BITS            4
 
 #define RESET_SIGNAL_BYTES     20
-#define SPI_BUFFER_SIZE_BYTES  (RESET_SIGNAL_BYTES + (3 * (WS2812_NUM_LEDS * WS2812_BITS)))
+#define LED_SIZE_BYTES         (3 * WS2812_BITS)
+#define SPI_BUFFER_SIZE_BYTES  (RESET_SIGNAL_BYTES + (WS2812_NUM_LEDS * LED_SIZE_BYTES))
 
-SL_ALIGN(4) static uint8_t spi_tx_buffer[SPI_BUFFER_SIZE_BYTES] = {0};
+// Changed and dithering pixels are tracked as bitmasks
+#if WS2812_NUM_LEDS > 32
+#error "At most 32 LEDs are supported"
+#endif
+
+#define ALL_PIXELS             ((uint32_t)(((uint64_t)1 << WS2812_NUM_LEDS) - 1))
+#define DEFAULT_LEVEL          19275  // 75 * 257, dim white
+
+// Double buffered: a frame is encoded into one buffer while the other is being sent
+#define SPI_FRAME_COUNT        2
+#define NO_FRAME               0xFF
+
+SL_ALIGN(4) static uint8_t spi_tx_buffer[SPI_FRAME_COUNT][SPI_BUFFER_SIZE_BYTES] = {0};
+
+// Frame being sent and the encoded frame queued behind it, or `NO_FRAME`. Shared with
+// the transfer complete callback, which runs in the DMA interrupt.
+static volatile uint8_t in_flight_frame = NO_FRAME;
+static volatile uint8_t ready_frame = NO_FRAME;
 
 // While an array of `uint32_t`s is possible, creating multiple EUSART instances causes
 // issues with bit ordering during SPI transfer. This may be due to LDMA word/byte
@@ -62,55 +81,117 @@ static void precompute_ws2812_patterns(void)
     }
 }
 
-// Temporal dithering: rapidly flicker between two 8-bit values, keeping track of the
-// running error in `accum`. Returns the dithered 8-bit value.
-static uint8_t dither_channel(uint16_t value, uint8_t *accum)
+// 16-bit channels map onto 8-bit levels in steps of 257, so that `v * 257` (`RGB8`) is
+// exactly level `v` and only values in between need dithering
+#define WS2812_LEVEL_STEP      257
+
+// Temporal dithering: a first order sigma-delta modulator flickers between two 8-bit
+// levels, carrying the exact remainder in `accum` (in 1/257 of a level) from frame to
+// frame. Returns the dithered 8-bit value.
+static uint8_t dither_channel(uint16_t value, uint16_t *accum)
 {
-    uint8_t base = value >> 8;
-    uint8_t frac = value & 0xFF;
+    uint8_t base = value / WS2812_LEVEL_STEP;
 
-    uint8_t prev = *accum;
-    *accum += frac;
+    *accum += value % WS2812_LEVEL_STEP;
 
-    // On overflow, output base + 1
-    if (*accum < prev) {
-        return base < 255 ? base + 1 : 255;
+    // 65535 is exactly level 255, so `base + 1` never overflows
+    if (*accum >= WS2812_LEVEL_STEP) {
+        *accum -= WS2812_LEVEL_STEP;
+        return base + 1;
     }
 
     return base;
 }
 
-// Internal context type
 typedef struct {
     uint16_t red;
     uint16_t green;
     uint16_t blue;
 
-    uint8_t dither_accum_red;
-    uint8_t dither_accum_green;
-    uint8_t dither_accum_blue;
+    uint16_t dither_accum_red;
+    uint16_t dither_accum_green;
+    uint16_t dither_accum_blue;
+} ws2812_pixel_t;
+
+// Internal context type
+typedef struct {
+    ws2812_pixel_t pixels[WS2812_NUM_LEDS];
+
+    // Pixels between two 8-bit levels, which are re-encoded every frame
+    uint32_t dither_mask;
+
+    // Per frame buffer, the pixels that changed since it was last encoded
+    uint32_t dirty_mask[SPI_FRAME_COUNT];
+
+    // Pixels or state changed since the last frame was queued
+    bool changed;
 
     sl_led_state_t state;
 } ws2812_context_t;
 
 static ws2812_context_t ws2812_context = {
-    .red = 19275,    // ~75/255 * 65535, dim white default
-    .green = 19275,
-    .blue = 19275,
-    .dither_accum_red = 0,
-    .dither_accum_green = 0,
-    .dither_accum_blue = 0,
+    .dirty_mask = { ALL_PIXELS, ALL_PIXELS },
+    .changed = true,
     .state = SL_LED_CURRENT_STATE_OFF
 };
 
-static void ws2812_led_apply_color(ws2812_context_t *ctx)
+static void mark_dirty(ws2812_context_t *ctx, uint32_t mask)
+{
+    for (int frame = 0; frame < SPI_FRAME_COUNT; frame++) {
+        ctx->dirty_mask[frame] |= mask;
+    }
+
+    ctx->changed = true;
+}
+
+static void set_state(ws2812_context_t *ctx, sl_led_state_t state)
 {
+    if (ctx->state != state) {
+        ctx->state = state;
+        mark_dirty(ctx, ALL_PIXELS);
+    }
+}
+
+static void ws2812_transfer_complete(SPIDRV_Handle_t handle, Ecode_t transfer_status, int items_transferred);
+
+// Must be called with interrupts masked
+static void ws2812_start_transfer(uint8_t frame)
+{
+    Ecode_t status = SPIDRV_MTransmit(sl_spidrv_eusart_ws2812_handle,
+                                      spi_tx_buffer[frame],
+                                      SPI_BUFFER_SIZE_BYTES,
+                                      ws2812_transfer_complete);
+
+    in_flight_frame = (status == ECODE_EMDRV_SPIDRV_OK) ? frame : NO_FRAME;
+}
+
+static void ws2812_transfer_complete(SPIDRV_Handle_t handle, Ecode_t transfer_status, int items_transferred)
+{
+    (void)handle;
+    (void)transfer_status;
+    (void)items_transferred;
+
+    uint8_t frame = ready_frame;
+
+    in_flight_frame = NO_FRAME;
+    ready_frame = NO_FRAME;
+
+    // Only hand the already encoded frame over, the leading reset bytes keep the LEDs
+    // latched between back to back frames
+    if (frame != NO_FRAME) {
+        ws2812_start_transfer(frame);
+    }
+}
+
+static void ws2812_encode_pixel(ws2812_context_t *ctx, uint8_t frame, uint8_t index)
+{
+    ws2812_pixel_t *pixel = &ctx->pixels[index];
     uint8_t r, g, b;
 
     if (ctx->state == SL_LED_CURRENT_STATE_ON) {
-        r = dither_channel(ctx->red, &ctx->dither_accum_red);
-        g = dither_channel(ctx->green, &ctx->dither_accum_green);
-        b = dither_channel(ctx->blue, &ctx->dither_accum_blue);
+        r = dither_channel(pixel->red, &pixel->dither_accum_red);
+        g = dither_channel(pixel->green, &pixel->dither_accum_green);
+        b = dither_channel(pixel->blue, &pixel->dither_accum_blue);
     } else {
         r = 0;
         g = 0;
@@ -118,20 +199,61 @@ static void ws2812_led_apply_color(ws2812_context_t *ctx)
     }
 
     // First `RESET_SIGNAL_BYTES` bytes are reserved for reset signal
-    uint8_t *spi_ptr = &spi_tx_buffer[RESET_SIGNAL_BYTES];
+    uint8_t *spi_ptr = &spi_tx_buffer[frame][RESET_SIGNAL_BYTES + (index * LED_SIZE_BYTES)];
+
+    memcpy(spi_ptr, ws2812_lookup[g], 4);
+    spi_ptr += 4;
 
-    for (int i = 0; i < WS2812_NUM_LEDS; i++) {
-        memcpy(spi_ptr, ws2812_lookup[g], 4);
-        spi_ptr += 4;
+    memcpy(spi_ptr, ws2812_lookup[r], 4);
+    spi_ptr += 4;
 
-        memcpy(spi_ptr, ws2812_lookup[r], 4);
-        spi_ptr += 4;
+    memcpy(spi_ptr, ws2812_lookup[b], 4);
+}
+
+static void ws2812_led_apply_color(ws2812_context_t *ctx)
+{
+    uint8_t frame;
 
-        memcpy(spi_ptr, ws2812_lookup[b], 4);
-        spi_ptr += 4;
+    // Without changes or dithering the LEDs already show this frame, don't send it again
+    bool dithering = (ctx->state == SL_LED_CURRENT_STATE_ON) && (ctx->dither_mask != 0);
+
+    if (!ctx->changed && !dithering) {
+        return;
+    }
+    ctx->changed = false;
+
+    CORE_DECLARE_IRQ_STATE;
+
+    // Encode into the buffer that is not being sent. A frame still queued in it is
+    // withdrawn first and replaced by this newer one.
+    CORE_ENTER_ATOMIC();
+    frame = (in_flight_frame == 0) ? 1 : 0;
+    if (ready_frame == frame) {
+        ready_frame = NO_FRAME;
+    }
+    CORE_EXIT_ATOMIC();
+
+    // The buffer still holds the frame it last sent, only changed pixels are encoded
+    uint32_t encode_mask = ctx->dirty_mask[frame];
+    ctx->dirty_mask[frame] = 0;
+
+    if (dithering) {
+        encode_mask |= ctx->dither_mask;
+    }
+
+    for (uint8_t i = 0; encode_mask != 0; i++, encode_mask >>= 1) {
+        if (encode_mask & 1) {
+            ws2812_encode_pixel(ctx, frame, i);
+        }
     }
 
-    SPIDRV_MTransmit(sl_spidrv_eusart_ws2812_handle, spi_tx_buffer, SPI_BUFFER_SIZE_BYTES, NULL);
+    CORE_ENTER_ATOMIC();
+    if (in_flight_frame == NO_FRAME) {
+        ws2812_start_transfer(frame);
+    } else {
+        ready_frame = frame;
+    }
+    CORE_EXIT_ATOMIC();
 }
 
 static sl_status_t ws2812_led_init(void *context)
@@ -144,22 +266,22 @@ static sl_status_t ws2812_led_init(void *context)
 static void ws2812_led_turn_on(void *context)
 {
     ws2812_context_t *ctx = (ws2812_context_t *)context;
-    ctx->state = SL_LED_CURRENT_STATE_ON;
+    set_state(ctx, SL_LED_CURRENT_STATE_ON);
 }
 
 static void ws2812_led_turn_off(void *context)
 {
     ws2812_context_t *ctx = (ws2812_context_t *)context;
-    ctx->state = SL_LED_CURRENT_STATE_OFF;
+    set_state(ctx, SL_LED_CURRENT_STATE_OFF);
 }
 
 static void ws2812_led_toggle(void *context)
 {
     ws2812_context_t *ctx = (ws2812_context_t *)context;
     if (ctx->state == SL_LED_CURRENT_STATE_ON) {
-        ctx->state = SL_LED_CURRENT_STATE_OFF;
+        set_state(ctx, SL_LED_CURRENT_STATE_OFF);
     } else {
-        ctx->state = SL_LED_CURRENT_STATE_ON;
+        set_state(ctx, SL_LED_CURRENT_STATE_ON);
     }
 }
 
@@ -169,20 +291,22 @@ static sl_led_state_t ws2812_led_get_state(void *context)
     return ctx->state;
 }
 
+// The `sl_led_rgb_pwm_t` interface treats all pixels as a single LED
 static void ws2812_led_set_color(void *context, uint16_t red, uint16_t green, uint16_t blue)
 {
-    ws2812_context_t *ctx = (ws2812_context_t *)context;
-    ctx->red = red;
-    ctx->green = green;
-    ctx->blue = blue;
+    (void)context;
+
+    for (uint8_t i = 0; i < WS2812_NUM_LEDS; i++) {
+        ws2812_led_driver_set_pixel(i, red, green, blue);
+    }
 }
 
 static void ws2812_led_get_color(void *context, uint16_t *red, uint16_t *green, uint16_t *blue)
 {
     ws2812_context_t *ctx = (ws2812_context_t *)context;
-    *red = ctx->red;
-    *green = ctx->green;
-    *blue = ctx->blue;
+    *red = ctx->pixels[0].red;
+    *green = ctx->pixels[0].green;
+    *blue = ctx->pixels[0].blue;
 }
 
 void ws2812_led_driver_refresh(void)
@@ -190,6 +314,43 @@ void ws2812_led_driver_refresh(void)
     ws2812_led_apply_color(&ws2812_context);
 }
 
+void ws2812_led_driver_set_pixel(uint8_t index, uint16_t red, uint16_t green, uint16_t blue)
+{
+    ws2812_context_t *ctx = &ws2812_context;
+
+    if (index >= WS2812_NUM_LEDS) {
+        return;
+    }
+
+    ws2812_pixel_t *pixel = &ctx->pixels[index];
+    uint32_t bit = 1UL << index;
+
+    if ((pixel->red == red) && (pixel->green == green) && (pixel->blue == blue)) {
+        return;
+    }
+
+    pixel->red = red;
+    pixel->green = green;
+    pixel->blue = blue;
+
+    if (((red % WS2812_LEVEL_STEP) != 0)
+        || ((green % WS2812_LEVEL_STEP) != 0)
+        || ((blue % WS2812_LEVEL_STEP) != 0)) {
+        ctx->dither_mask |= bit;
+    } else {
+        ctx->dither_mask &= ~bit;
+    }
+
+    mark_dirty(ctx, bit);
+}
+
+bool ws2812_led_driver_needs_dither(void)
+{
+    const ws2812_context_t *ctx = &ws2812_context;
+
+    return (ctx->state == SL_LED_CURRENT_STATE_ON) && (ctx->dither_mask != 0);
+}
+
 const sl_led_rgb_pwm_t sl_led_ws2812 = {
     .led_common = {
         .context = &ws2812_context,
@@ -203,8 +364,25 @@ const sl_led_rgb_pwm_t sl_led_ws2812 = {
     .get_rgb_color = ws2812_led_get_color
 };
 
+// Spreads the dithering phase of the pixels evenly over one level. Each accumulator
+// advances by the same amount for the same color, so the phases stay apart: pixels
+// showing one color light up their extra level in turn, rather than all in the same
+// frame, and the combined output flickers at a fraction of the amplitude.
+static void stagger_dither_phases(ws2812_context_t *ctx)
+{
+    for (uint8_t i = 0; i < WS2812_NUM_LEDS; i++) {
+        uint16_t phase = (i * WS2812_LEVEL_STEP) / WS2812_NUM_LEDS;
+
+        ctx->pixels[i].dither_accum_red = phase;
+        ctx->pixels[i].dither_accum_green = phase;
+        ctx->pixels[i].dither_accum_blue = phase;
+    }
+}
+
 void ws2812_led_driver_init(void)
 {
     precompute_ws2812_patterns();
+    stagger_dither_phases(&ws2812_context);
+    ws2812_led_set_color(&ws2812_context, DEFAULT_LEVEL, DEFAULT_LEVEL, DEFAULT_LEVEL);
     sl_led_init(&sl_led_ws2812.led_common);
 }
@@ -10,7 +10,6 @@
 #include "led_manager.h"
 
 #include "em_core.h"
-#include "sl_sleeptimer.h"
 
 #include "sl_button.h"
 #include "sl_simple_button_instances.h"
@@ -25,15 +24,23 @@
 #include "stack-info.h"
 #endif
 
-static sl_sleeptimer_timer_handle_t reset_timer;
-static sl_sleeptimer_timer_handle_t blink_timer;
+// Per cycle: a pause, then `cycle` blinks with an off gap before all but the first
+#define RESET_STEPS_PER_CYCLE 4
+#define RESET_STEP_COUNT      (ZBT2_RESET_BUTTON_CYCLES * RESET_STEPS_PER_CYCLE)
 
-static uint8_t reset_cycle = 0;
-static uint8_t blink_count = 0;
-static bool led_on = false;
+#if RESET_STEP_COUNT > LED_ANIMATION_MAX_STEPS
+#error "Too many reset cycles for one LED animation"
+#endif
+
+// The first off gap of a cycle is taken out of its pause
+#define RESET_CYCLE_PAUSE_MS (ZBT2_RESET_BUTTON_CYCLE_DELAY_MS + ZBT2_RESET_BUTTON_BLINK_START_DELAY_MS)
+
+#if RESET_CYCLE_PAUSE_MS < ZBT2_RESET_BUTTON_BLINK_OFF_MS
+#error "The reset cycle delay must be at least as long as the blink off time"
+#endif
 
-// Task to handle the LED blinking pattern
-static void blink_task(sl_sleeptimer_timer_handle_t *handle, void *data);
+static led_keyframe_t reset_animation[RESET_STEP_COUNT];
+static bool reset_animation_built = false;
 
 // Resets network settings and reboots the adapter
 static void reset_adapter(void)
@@ -58,63 +65,58 @@ static void reset_adapter(void)
     NVIC_SystemReset();
 }
 
-// Called when the reset timer expires.
-static void reset_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+// The LED manager plays the whole sequence, the adapter is reset once it has ended.
+// Each cycle ends on its last blink, like the timer driven sequence it replaced.
+static void build_reset_animation(void)
 {
-    (void)handle;
-    (void)data;
+    for (uint8_t cycle = 0; cycle < ZBT2_RESET_BUTTON_CYCLES; cycle++) {
+        led_keyframe_t *steps = &reset_animation[cycle * RESET_STEPS_PER_CYCLE];
+        uint8_t off_step = (cycle * RESET_STEPS_PER_CYCLE) + 1;
+
+        steps[0] = (led_keyframe_t) {
+            .op = LED_KEYFRAME_TRANSPARENT,
+            .duration_ms = RESET_CYCLE_PAUSE_MS - ZBT2_RESET_BUTTON_BLINK_OFF_MS,
+        };
+        // Off reveals the previous state
+        steps[1] = (led_keyframe_t) {
+            .op = LED_KEYFRAME_TRANSPARENT,
+            .duration_ms = ZBT2_RESET_BUTTON_BLINK_OFF_MS,
+        };
+        steps[2] = (led_keyframe_t) {
+            .op = LED_KEYFRAME_HOLD,
+            .duration_ms = ZBT2_RESET_BUTTON_BLINK_ON_MS,
+            .color = { LED_COLOR_RESET_ORANGE.r, LED_COLOR_RESET_ORANGE.g, LED_COLOR_RESET_ORANGE.b },
+        };
+        steps[3] = (led_keyframe_t) {
+            .op = LED_KEYFRAME_LOOP,
+            .arg = off_step,
+            .duration_ms = cycle,
+        };
+    }
 
-    reset_cycle++;
-    sl_sleeptimer_start_timer_ms(&blink_timer, ZBT2_RESET_BUTTON_BLINK_START_DELAY_MS, blink_task, NULL, 0, 0);
+    reset_animation_built = true;
 }
 
-// Task to handle the LED blinking pattern.
-static void blink_task(sl_sleeptimer_timer_handle_t *handle, void *data)
+static void reset_animation_done(led_priority_t priority)
 {
-    (void)handle;
-    (void)data;
-
-    // If the LED is on, turn it off (clear the layer to reveal previous state)
-    if (led_on) {
-        led_manager_clear_pattern(LED_PRIORITY_CRITICAL);
-        led_on = false;
-
-        // If we have blinked enough times, then start the next reset cycle
-        if (blink_count >= reset_cycle) {
-            blink_count = 0;
-            if (reset_cycle == ZBT2_RESET_BUTTON_CYCLES) {
-                reset_adapter();
-            } else {
-                sl_sleeptimer_start_timer_ms(&reset_timer, ZBT2_RESET_BUTTON_CYCLE_DELAY_MS, reset_timer_callback, NULL, 0, 0);
-            }
-        } else {
-            sl_sleeptimer_start_timer_ms(&blink_timer, ZBT2_RESET_BUTTON_BLINK_OFF_MS, blink_task, NULL, 0, 0);
-        }
-    } else {
-        led_manager_set_color(LED_PRIORITY_CRITICAL, LED_COLOR_RESET_ORANGE);
-        led_on = true;
-        blink_count++;
-        sl_sleeptimer_start_timer_ms(&blink_timer, ZBT2_RESET_BUTTON_BLINK_ON_MS, blink_task, NULL, 0, 0);
-    }
+    (void)priority;
+    reset_adapter();
 }
 
 void zbt2_reset_button_handle_state(bool pressed)
 {
-    // Stop any running timers first
-    sl_sleeptimer_stop_timer(&reset_timer);
-    sl_sleeptimer_stop_timer(&blink_timer);
-
     if (pressed) {
-        // Reset state and start the cycle, this is hit only when the button is initially pressed
-        reset_cycle = 0;
-        blink_count = 0;
-        led_on = false;
+        if (!reset_animation_built) {
+            build_reset_animation();
+        }
 
-        sl_sleeptimer_start_timer_ms(&reset_timer, ZBT2_RESET_BUTTON_CYCLE_DELAY_MS, reset_timer_callback, NULL, 0, 0);
+        led_manager_play_animation(LED_PRIORITY_CRITICAL,
+                                   reset_animation,
+                                   RESET_STEP_COUNT,
+                                   reset_animation_done);
     } else {
         // This is the release and will only be hit if we cancel early.
         led_manager_clear_pattern(LED_PRIORITY_CRITICAL);
-        led_on = false;
     }
 }
 
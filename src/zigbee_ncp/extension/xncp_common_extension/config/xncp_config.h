@@ -23,6 +23,64 @@
 #define XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE 200
 #endif
 
+// <o XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE> Manual source route relay pool size
+// <i> Number of relay chunks (3 relays each) shared by all manual source routes.
+// <i> Least recently used routes are evicted when the pool runs out.
+// <i> Default: XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE
+#ifndef XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE
+#define XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE
+#endif
+
+// <o XNCP_ADDRESS_CACHE_SIZE> Address cache size <1-64>
+// <i> Number of recently used EUI64s whose address table index is cached for the
+// <i> combined send extended timeout path
+// <i> Default: 16
+#ifndef XNCP_ADDRESS_CACHE_SIZE
+#define XNCP_ADDRESS_CACHE_SIZE 16
+#endif
+
+// <o XNCP_ROUTE_TABLE_JOURNAL_SIZE> Route table journal size
+// <i> Number of route table changes kept for incremental sync. Hosts that fall
+// <i> further behind have to read the whole route table again.
+// <i> Only used with XNCP_ROUTE_TABLE_JOURNAL_ENABLED.
+// <i> Default: 64
+#ifndef XNCP_ROUTE_TABLE_JOURNAL_SIZE
+#define XNCP_ROUTE_TABLE_JOURNAL_SIZE 64
+#endif
+
+// <o XNCP_MULTICAST_FILTER_SIZE> Multicast filter size
+// <i> Number of group IDs the host can restrict incoming group frames to
+// <i> Default: 64
+#ifndef XNCP_MULTICAST_FILTER_SIZE
+#define XNCP_MULTICAST_FILTER_SIZE 64
+#endif
+
+// <o XNCP_INCOMING_FILTER_MAX_RULES> Incoming filter rule count
+// <i> Number of profile/cluster drop rules the host can configure
+// <i> Only used with XNCP_INCOMING_FILTER_ENABLED.
+// <i> Default: 16
+#ifndef XNCP_INCOMING_FILTER_MAX_RULES
+#define XNCP_INCOMING_FILTER_MAX_RULES 16
+#endif
+
+// <o XNCP_INCOMING_FILTER_DEDUP_SIZE> Incoming filter deduplication size <1-255>
+// <i> Number of sender/endpoint/cluster/attribute keys whose last forwarded report is
+// <i> remembered for deduplication
+// <i> Only used with XNCP_INCOMING_FILTER_ENABLED.
+// <i> Default: 32
+#ifndef XNCP_INCOMING_FILTER_DEDUP_SIZE
+#define XNCP_INCOMING_FILTER_DEDUP_SIZE 32
+#endif
+
+// <o XNCP_NEIGHBOR_STATS_SIZE> Neighbor statistics table size <1-255>
+// <i> Number of neighbors link quality and MAC delivery statistics are kept for,
+// <i> should match the stack's neighbor table size
+// <i> Only used with XNCP_NEIGHBOR_STATS_ENABLED.
+// <i> Default: 26
+#ifndef XNCP_NEIGHBOR_STATS_SIZE
+#define XNCP_NEIGHBOR_STATS_SIZE 26
+#endif
+
 // <s XNCP_MFG_MANUF_NAME> Manufacturer name override
 // <i> String returned for EZSP_MFG_STRING token override
 #ifndef XNCP_MFG_MANUF_NAME
@@ -0,0 +1,36 @@
+/*
+ * address_cache.h
+ *
+ * EUI64 -> address table index cache for the combined send path
+ */
+
+#ifndef ADDRESS_CACHE_H
+#define ADDRESS_CACHE_H
+
+#include <stdint.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+typedef struct AddressCacheStats {
+  uint32_t lookups;
+  uint32_t hits;       // Lookups answered without scanning the address table
+  uint32_t inserts;    // New entries written to the address table
+  uint32_t evictions;  // Inserts that replaced an entry still in use
+} AddressCacheStats;
+
+void address_cache_init(void);
+
+// Forgets every cached index, e.g. after the address table was cleared
+void address_cache_clear(void);
+
+// Sets the extended timeout flag of `eui64`, creating an address table entry for it
+// if needed. New entries take an unused slot first and otherwise replace one that
+// has not been referenced recently.
+void address_cache_set_extended_timeout(uint8_t *eui64,
+                                        xncp_node_id_t node_id,
+                                        bool extended_timeout);
+
+const AddressCacheStats* address_cache_get_stats(void);
+void address_cache_reset_stats(void);
+
+#endif // ADDRESS_CACHE_H
@@ -0,0 +1,71 @@
+/*
+ * incoming_filter.h
+ *
+ * Drops unwanted and duplicate incoming APS frames before they are sent to the host
+ * (XNCP_FEATURE_INCOMING_FILTER)
+ *
+ * Enabled with XNCP_INCOMING_FILTER_ENABLED. When disabled the commands are not
+ * registered and every frame is accepted.
+ */
+
+#ifndef INCOMING_FILTER_H
+#define INCOMING_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+// Matches every cluster of a profile in a drop rule
+#define INCOMING_FILTER_ANY_CLUSTER 0xFFFF
+
+typedef struct IncomingFilterStats {
+  uint32_t passed;
+  uint32_t dropped_by_rule;
+  uint32_t dropped_duplicates;
+} IncomingFilterStats;
+
+#if XNCP_INCOMING_FILTER_ENABLED
+
+// Starts out without rules and with deduplication disabled
+void incoming_filter_init(void);
+
+void incoming_filter_clear_rules(void);
+
+// Drops every frame for `profile_id` and `cluster_id`. Returns false if there are
+// already XNCP_INCOMING_FILTER_MAX_RULES rules.
+bool incoming_filter_add_rule(uint16_t profile_id, uint16_t cluster_id);
+
+// Drops an attribute report identical to the last one forwarded for the same sender,
+// endpoint, cluster and attribute, if that was less than `window_ms` ago. Reports
+// are keyed on their first attribute. 0 disables deduplication.
+void incoming_filter_set_dedup_window(uint16_t window_ms);
+
+// Returns true if the frame should be delivered
+bool incoming_filter_accepts(xncp_node_id_t sender,
+                             const sl_zigbee_aps_frame_t *aps_frame,
+                             const uint8_t *message,
+                             uint8_t message_length);
+
+const IncomingFilterStats* incoming_filter_get_stats(void);
+void incoming_filter_reset_stats(void);
+
+#else
+
+static inline void incoming_filter_init(void) {}
+
+static inline bool incoming_filter_accepts(xncp_node_id_t sender,
+                                           const sl_zigbee_aps_frame_t *aps_frame,
+                                           const uint8_t *message,
+                                           uint8_t message_length)
+{
+    (void)sender;
+    (void)aps_frame;
+    (void)message;
+    (void)message_length;
+    return true;
+}
+
+#endif // XNCP_INCOMING_FILTER_ENABLED
+
+#endif // INCOMING_FILTER_H
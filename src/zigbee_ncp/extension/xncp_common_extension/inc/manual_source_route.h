@@ -0,0 +1,58 @@
+/*
+ * manual_source_route.h
+ *
+ * Manual source route table, indexed by destination node ID
+ */
+
+#ifndef MANUAL_SOURCE_ROUTE_H
+#define MANUAL_SOURCE_ROUTE_H
+
+#include <stdint.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+typedef struct ManualSourceRoute {
+  uint16_t destination;
+  uint16_t lru_prev;
+  uint16_t lru_next;
+  uint16_t first_chunk;
+  uint8_t num_relays;
+  uint8_t remaining_uses;  // 0 = unlimited
+  uint8_t hits;            // Saturates at UINT8_MAX
+  uint8_t failures;        // Saturates at UINT8_MAX
+  uint16_t expiry_s;       // Seconds after the table's expiry epoch, 0 = never expires
+} ManualSourceRoute;
+
+void manual_source_route_init(void);
+
+// Drops every installed route
+void manual_source_route_clear(void);
+
+// Returns the route for `destination`, or NULL if none is installed or it expired
+ManualSourceRoute* manual_source_route_get(xncp_node_id_t destination);
+
+// Installs or replaces the route for `node_id`. `relay_bytes` holds `num_relays`
+// little endian node IDs. The route is dropped after `max_uses` messages or `ttl_s`
+// seconds, whichever comes first (0 disables either limit). When the table or the
+// relay pool is full, the least recently used routes are evicted.
+void manual_source_route_install(xncp_node_id_t node_id,
+                                 const uint8_t *relay_bytes,
+                                 uint8_t num_relays,
+                                 uint8_t max_uses,
+                                 uint16_t ttl_s);
+
+// Copies the relays of `route` into `relays` in the order they are sent over the air
+// (closest to the destination first). Returns the number of relays.
+uint8_t manual_source_route_get_relays(const ManualSourceRoute *route,
+                                       uint16_t relays[XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT]);
+
+// Accounts for a message sent over `route`, removing it once it runs out of uses.
+// `route` must not be accessed afterwards.
+void manual_source_route_use(ManualSourceRoute *route);
+
+// Seconds until `route` expires, 0 if it has no TTL
+uint16_t manual_source_route_get_ttl(const ManualSourceRoute *route);
+
+void manual_source_route_remove(ManualSourceRoute *route);
+
+#endif // MANUAL_SOURCE_ROUTE_H
@@ -0,0 +1,75 @@
+/*
+ * memory_stats.h
+ *
+ * Current and peak usage of stack pools and buffers (XNCP_FEATURE_MEMORY_STATS)
+ *
+ * Enabled with XNCP_MEMORY_STATS_ENABLED. When disabled the command is not registered
+ * and the hooks below do nothing.
+ */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <stdint.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+// Reported in this order, new pools are only ever appended
+typedef enum {
+  MEMORY_POOL_PACKET_BUFFER_HEAP = 0,     // Bytes
+  MEMORY_POOL_APS_UNICAST = 1,            // Unicasts waiting for an APS ack
+  MEMORY_POOL_BROADCAST_TABLE = 2,        // Estimate, see memory_stats.c
+  MEMORY_POOL_SOURCE_ROUTE_TABLE = 3,     // The stack's own source routes
+  MEMORY_POOL_MANUAL_SOURCE_ROUTE_TABLE = 4,
+  MEMORY_POOL_MANUAL_SOURCE_ROUTE_RELAYS = 5,  // Relay chunks
+  MEMORY_POOL_COUNT
+} MemoryPool;
+
+typedef struct MemoryPoolStats {
+  uint16_t capacity;      // 0 if the pool has no fixed size
+  uint16_t current;
+  uint16_t high_water;
+  uint16_t full_count;    // Saturating, allocations that failed or evicted an entry
+} MemoryPoolStats;
+
+// Main loop process action, samples the pools that can only be polled
+void memory_stats_process_action(void);
+
+#if XNCP_MEMORY_STATS_ENABLED
+
+void memory_stats_init(void);
+
+// Polls the packet buffer heap and the stack's source route table
+void memory_stats_sample_stack(void);
+
+void memory_stats_set_capacity(MemoryPool pool, uint16_t capacity);
+void memory_stats_update(MemoryPool pool, uint16_t current);
+void memory_stats_record_full(MemoryPool pool);
+
+// Unicasts hold an APS slot from being queued until their message sent callback
+void memory_stats_aps_unicast_queued(void);
+void memory_stats_aps_unicast_completed(void);
+
+// A broadcast or multicast sent or received, which holds a broadcast table entry
+void memory_stats_broadcast_seen(void);
+
+const MemoryPoolStats* memory_stats_get(MemoryPool pool);
+
+// Lowers every high-water mark to the current usage and clears the full counts
+void memory_stats_reset(void);
+
+#else
+
+static inline void memory_stats_init(void) {}
+static inline void memory_stats_update(MemoryPool pool, uint16_t current)
+{
+    (void)pool;
+    (void)current;
+}
+static inline void memory_stats_record_full(MemoryPool pool) { (void)pool; }
+static inline void memory_stats_aps_unicast_completed(void) {}
+static inline void memory_stats_broadcast_seen(void) {}
+
+#endif // XNCP_MEMORY_STATS_ENABLED
+
+#endif // MEMORY_STATS_H
@@ -0,0 +1,42 @@
+/*
+ * multicast_filter.h
+ *
+ * Set of multicast group IDs forwarded to the host
+ */
+
+#ifndef MULTICAST_FILTER_H
+#define MULTICAST_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+typedef struct MulticastFilterStats {
+  uint32_t accepted;
+  uint32_t rejected;
+} MulticastFilterStats;
+
+// Starts out disabled, accepting every group
+void multicast_filter_init(void);
+
+// With the filter disabled every group is accepted, otherwise only the added ones
+void multicast_filter_set_enabled(bool enabled);
+bool multicast_filter_is_enabled(void);
+
+void multicast_filter_clear(void);
+
+// Returns false if the filter is full. Adding a group twice is a no-op.
+bool multicast_filter_add(xncp_multicast_id_t group_id);
+
+uint16_t multicast_filter_get_count(void);
+
+bool multicast_filter_contains(xncp_multicast_id_t group_id);
+
+// Accounts for a group frame that was checked against the enabled filter
+void multicast_filter_record(bool accepted);
+
+const MulticastFilterStats* multicast_filter_get_stats(void);
+void multicast_filter_reset_stats(void);
+
+#endif // MULTICAST_FILTER_H
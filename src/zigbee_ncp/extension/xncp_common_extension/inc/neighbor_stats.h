@@ -0,0 +1,77 @@
+/*
+ * neighbor_stats.h
+ *
+ * Per-neighbor link quality and MAC delivery statistics (XNCP_FEATURE_NEIGHBOR_STATS)
+ *
+ * Enabled with XNCP_NEIGHBOR_STATS_ENABLED. When disabled the command is not registered
+ * and the hooks below do nothing.
+ */
+
+#ifndef NEIGHBOR_STATS_H
+#define NEIGHBOR_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+// Averages are exponentially weighted, in 1/16 dBm or 1/16 LQI units
+#define NEIGHBOR_STATS_AVERAGE_SCALE 16
+
+typedef struct NeighborStats {
+  xncp_node_id_t node_id;
+  int16_t rssi_average;
+  uint16_t lqi_average;
+  int8_t rssi_min;
+  int8_t rssi_max;
+  uint8_t lqi_min;
+  uint8_t lqi_max;
+  bool has_average;       // Set by the first received frame
+  uint32_t last_seen_ms;
+  // Saturating counters
+  uint16_t rx_packets;
+  uint16_t tx_packets;    // MAC unicasts acknowledged by the neighbor
+  uint16_t mac_retries;
+  uint16_t tx_failures;   // MAC unicasts never acknowledged
+} NeighborStats;
+
+#if XNCP_NEIGHBOR_STATS_ENABLED
+
+void neighbor_stats_init(void);
+
+// Forgets every neighbor, e.g. after leaving the network
+void neighbor_stats_clear(void);
+
+// Frames received from a node are only counted if it is a neighbor, multi-hop frames
+// carry the link quality of the last hop instead
+void neighbor_stats_record_rx(xncp_node_id_t node_id, int8_t rssi, uint8_t lqi);
+
+// MAC level unicast results, the node is a neighbor by definition
+void neighbor_stats_record_tx_success(xncp_node_id_t node_id);
+void neighbor_stats_record_mac_retry(xncp_node_id_t node_id);
+void neighbor_stats_record_tx_failure(xncp_node_id_t node_id);
+
+// Entries keep their index until they are evicted, so the table can be paged through.
+// Returns NULL for unused entries.
+const NeighborStats* neighbor_stats_get(uint8_t index);
+
+// Clears the counters and min/max of an entry, keeping the averages
+void neighbor_stats_reset(uint8_t index);
+
+#else
+
+static inline void neighbor_stats_init(void) {}
+static inline void neighbor_stats_clear(void) {}
+static inline void neighbor_stats_record_rx(xncp_node_id_t node_id, int8_t rssi, uint8_t lqi)
+{
+    (void)node_id;
+    (void)rssi;
+    (void)lqi;
+}
+static inline void neighbor_stats_record_tx_success(xncp_node_id_t node_id) { (void)node_id; }
+static inline void neighbor_stats_record_mac_retry(xncp_node_id_t node_id) { (void)node_id; }
+static inline void neighbor_stats_record_tx_failure(xncp_node_id_t node_id) { (void)node_id; }
+
+#endif // XNCP_NEIGHBOR_STATS_ENABLED
+
+#endif // NEIGHBOR_STATS_H
@@ -0,0 +1,61 @@
+/*
+ * route_table_journal.h
+ *
+ * Journal of route table changes, used for incremental route table sync
+ * (XNCP_FEATURE_ROUTE_TABLE_JOURNAL)
+ *
+ * Enabled with XNCP_ROUTE_TABLE_JOURNAL_ENABLED. When disabled the command is not
+ * registered and the hooks below do nothing.
+ */
+
+#ifndef ROUTE_TABLE_JOURNAL_H
+#define ROUTE_TABLE_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "xncp_types.h"
+#include "xncp_config.h"
+
+typedef struct RouteTableChange {
+  uint8_t index;
+  uint8_t status;
+  uint8_t cost;
+  uint16_t destination;
+  uint16_t old_next_hop;
+  uint16_t new_next_hop;
+} RouteTableChange;
+
+#if XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
+// Snapshots the current route table, changes are journaled relative to it
+void route_table_journal_init(void);
+
+// Journals every entry that changed since the last update, once per entry however
+// often it changed in between
+void route_table_journal_update(void);
+
+// Takes the current state of entry `index` as known without journaling it, for
+// entries the host wrote itself. Call route_table_journal_update() before the write,
+// so changes the stack made to the entry are still journaled.
+void route_table_journal_accept(uint8_t index);
+
+// Random value picked at boot, so the host can tell sequence numbers of a previous
+// boot apart from the current ones
+uint16_t route_table_journal_get_epoch(void);
+
+// Sequence number of the most recent change, 0 if nothing changed yet
+uint32_t route_table_journal_get_latest_sequence(void);
+
+// Returns the change with sequence number `sequence`, or NULL if it has not happened
+// yet or was already overwritten
+const RouteTableChange* route_table_journal_get(uint32_t sequence);
+
+#else
+
+static inline void route_table_journal_init(void) {}
+static inline void route_table_journal_update(void) {}
+static inline void route_table_journal_accept(uint8_t index) { (void)index; }
+
+#endif // XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
+#endif // ROUTE_TABLE_JOURNAL_H
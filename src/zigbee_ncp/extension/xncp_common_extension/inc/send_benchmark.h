@@ -0,0 +1,29 @@
+/*
+ * send_benchmark.h
+ *
+ * APS send path benchmark (XNCP_FEATURE_SEND_BENCHMARK)
+ *
+ * Enabled with XNCP_SEND_BENCHMARK_ENABLED. When disabled the commands are not
+ * registered and the hooks below do nothing.
+ */
+
+#ifndef SEND_BENCHMARK_H
+#define SEND_BENCHMARK_H
+
+#include "xncp_types.h"
+
+// Message tag of benchmark unicasts, their completions are counted by the benchmark
+#define SEND_BENCHMARK_MESSAGE_TAG 0xFE
+
+// Main loop process action, sends the unicasts that are due
+void send_benchmark_process_action(void);
+
+// Called from the message sent callback for every unicast
+void send_benchmark_message_sent(sl_status_t status, uint16_t message_tag);
+
+#if XNCP_SEND_BENCHMARK_ENABLED
+bool xncp_handle_start_send_benchmark(xncp_context_t *ctx);
+bool xncp_handle_get_send_benchmark_results(xncp_context_t *ctx);
+#endif
+
+#endif // SEND_BENCHMARK_H
@@ -2,14 +2,42 @@
 #define TX_POWER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "xncp_config.h"
 
+// 2.4 GHz O-QPSK channels
+#define TX_POWER_FIRST_CHANNEL 11
+#define TX_POWER_CHANNEL_COUNT 16
+
+#define TX_POWER_COUNTRY_CODE(c1, c2) ((uint16_t)(((uint8_t)(c1) << 8) | (uint8_t)(c2)))
+#define TX_POWER_COUNTRY_CODE_NONE    0xFFFF
+
+// Generated from the `xncp_tx_power` template contributions
+typedef struct {
+  uint16_t code;
+  int8_t recommended_power_dbm;
+  int8_t max_power_dbm;
+} TxPowerTableEntry;
+
+typedef struct {
+  uint16_t code;
+  uint8_t channel;
+  int8_t max_power_dbm;
+} TxPowerChannelLimit;
+
+extern const TxPowerTableEntry tx_power_table[];
+extern const uint8_t tx_power_table_size;
+extern const TxPowerChannelLimit tx_power_channel_limits[];
+
 typedef struct {
   char code[2];
   int8_t recommended_power_dbm;
   int8_t max_power_dbm;
+  int8_t channel_max_power_dbm[TX_POWER_CHANNEL_COUNT];  // Index 0 is channel 11
 } CountryTxPower;
 
-void get_tx_power_for_country(const char c1, const char c2, CountryTxPower *output);
+// Fills in the limits for a country, or the configured defaults if it is not listed.
+// Returns false in the latter case.
+bool get_tx_power_for_country(const char c1, const char c2, CountryTxPower *output);
 
-#endif // TX_POWER_H
\ No newline at end of file
+#endif // TX_POWER_H
@@ -9,6 +9,71 @@
 
 #include "xncp_types.h"
 
-extern const xncp_command_def_t xncp_common_commands[];
+// Command IDs (registered in xncp_common_commands.slcc)
+#define XNCP_CMD_SET_SOURCE_ROUTE_REQ            0x0001
+#define XNCP_CMD_GET_MFG_TOKEN_OVERRIDE_REQ      0x0002
+#define XNCP_CMD_GET_BUILD_STRING_REQ            0x0003
+#define XNCP_CMD_GET_FLOW_CONTROL_TYPE_REQ       0x0004
+#define XNCP_CMD_GET_CHIP_INFO_REQ               0x0005
+#define XNCP_CMD_SET_ROUTE_TABLE_ENTRY_REQ       0x0006
+#define XNCP_CMD_GET_ROUTE_TABLE_ENTRY_REQ       0x0007
+#define XNCP_CMD_GET_TX_POWER_INFO_REQ           0x0008
+#define XNCP_CMD_SEND_UNICAST_REQ                0x0009
+#define XNCP_CMD_GET_ROUTE_TABLE_RANGE_REQ       0x000B
+#define XNCP_CMD_SET_ROUTE_TABLE_RANGE_REQ       0x000C
+#define XNCP_CMD_SET_PERSISTENT_SOURCE_ROUTE_REQ 0x000D
+#define XNCP_CMD_GET_SOURCE_ROUTE_STATS_REQ      0x000E
+#define XNCP_CMD_CLEAR_SOURCE_ROUTE_REQ          0x000F
+#define XNCP_CMD_SEND_UNICAST_BATCH_REQ          0x0010
+#define XNCP_CMD_GET_ADDRESS_CACHE_STATS_REQ     0x0011
+#define XNCP_CMD_GET_ROUTE_TABLE_CHANGES_REQ     0x0013
+#define XNCP_CMD_SET_MULTICAST_FILTER_REQ        0x0014
+#define XNCP_CMD_GET_MULTICAST_FILTER_STATS_REQ  0x0015
+#define XNCP_CMD_SET_INCOMING_FILTER_REQ         0x0016
+#define XNCP_CMD_GET_INCOMING_FILTER_STATS_REQ   0x0017
+#define XNCP_CMD_GET_TX_POWER_PROFILE_REQ        0x0019
+#define XNCP_CMD_GET_NEIGHBOR_STATS_REQ          0x001A
+#define XNCP_CMD_START_SEND_BENCHMARK_REQ        0x001B
+#define XNCP_CMD_GET_SEND_BENCHMARK_RESULTS_REQ  0x001C
+#define XNCP_CMD_GET_MEMORY_STATS_REQ            0x001D
+
+// PHYs in the TX power profile (XNCP_FEATURE_TX_POWER_PROFILE)
+#define XNCP_TX_POWER_PHY_2P4GHZ_OQPSK           0x00
+
+// Notification event types (XNCP_FEATURE_NOTIFICATIONS)
+#define XNCP_EVENT_SOURCE_ROUTE_USED             0x00
+
+bool xncp_handle_set_source_route(xncp_context_t *ctx);
+bool xncp_handle_get_mfg_token_override(xncp_context_t *ctx);
+bool xncp_handle_get_build_string(xncp_context_t *ctx);
+bool xncp_handle_get_flow_control_type(xncp_context_t *ctx);
+bool xncp_handle_get_chip_info(xncp_context_t *ctx);
+bool xncp_handle_set_route_table_entry(xncp_context_t *ctx);
+bool xncp_handle_get_route_table_entry(xncp_context_t *ctx);
+bool xncp_handle_get_tx_power_info(xncp_context_t *ctx);
+bool xncp_handle_send_unicast(xncp_context_t *ctx);
+bool xncp_handle_get_route_table_range(xncp_context_t *ctx);
+bool xncp_handle_set_route_table_range(xncp_context_t *ctx);
+bool xncp_handle_set_persistent_source_route(xncp_context_t *ctx);
+bool xncp_handle_get_source_route_stats(xncp_context_t *ctx);
+bool xncp_handle_clear_source_route(xncp_context_t *ctx);
+bool xncp_handle_send_unicast_batch(xncp_context_t *ctx);
+bool xncp_handle_get_address_cache_stats(xncp_context_t *ctx);
+#if XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+bool xncp_handle_get_route_table_changes(xncp_context_t *ctx);
+#endif
+bool xncp_handle_set_multicast_filter(xncp_context_t *ctx);
+bool xncp_handle_get_multicast_filter_stats(xncp_context_t *ctx);
+#if XNCP_INCOMING_FILTER_ENABLED
+bool xncp_handle_set_incoming_filter(xncp_context_t *ctx);
+bool xncp_handle_get_incoming_filter_stats(xncp_context_t *ctx);
+#endif
+bool xncp_handle_get_tx_power_profile(xncp_context_t *ctx);
+#if XNCP_NEIGHBOR_STATS_ENABLED
+bool xncp_handle_get_neighbor_stats(xncp_context_t *ctx);
+#endif
+#if XNCP_MEMORY_STATS_ENABLED
+bool xncp_handle_get_memory_stats(xncp_context_t *ctx);
+#endif
 
 #endif // XNCP_COMMON_COMMANDS_H
@@ -0,0 +1,26 @@
+/*
+ * xncp_hash.h
+ *
+ * Hashing of 16-bit IDs for the open addressing tables of the common commands
+ */
+
+#ifndef XNCP_HASH_H
+#define XNCP_HASH_H
+
+#include <stdint.h>
+
+// 2^16 / golden ratio, odd
+#define XNCP_HASH_FIBONACCI_MULTIPLIER 40503U
+
+// Fibonacci hashing of `key` into [0, size). The low 16 bits of the product are the
+// fraction of key / golden ratio, which spreads sequential IDs evenly. The slot comes
+// from the high bits of that fraction, scaled by `size`, so IDs that only differ in
+// their high bits do not collide and `size` need not be a power of two.
+static inline uint16_t xncp_hash_u16(uint16_t key, uint16_t size)
+{
+    uint16_t fraction = (uint16_t)(key * XNCP_HASH_FIBONACCI_MULTIPLIER);
+
+    return (uint16_t)(((uint32_t)fraction * size) >> 16);
+}
+
+#endif // XNCP_HASH_H
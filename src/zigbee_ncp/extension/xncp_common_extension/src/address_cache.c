@@ -0,0 +1,290 @@
+/*
+ * address_cache.c
+ *
+ * EUI64 -> address table index cache for the combined send path
+ *
+ * The stack only looks up address table entries by scanning the whole table. A small
+ * fully associative cache of recently used EUI64s sits in front of that scan and also
+ * remembers each entry's extended timeout flag. Every address table and extended
+ * timeout write, whether it comes from the host over plain EZSP or from the XNCP
+ * itself, goes through the linker wrapped setters below, which keep the cache in step
+ * with the stack. A hit therefore costs a search of the cache only, and a stack call
+ * only when the flag actually changes.
+ *
+ * A miss scans the address table one entry at a time for the index and reads the flag
+ * from the stack, so it costs more than an uncached lookup. It is paid once per
+ * destination while that destination stays cached.
+ *
+ * When a new entry has to be added, unused entries are taken first. Otherwise the
+ * victim is picked with the CLOCK algorithm: every entry referenced through the cache
+ * gets a second chance before it can be replaced, so hot destinations are not evicted
+ * in favour of one-off ones.
+ */
+
+#include "address_cache.h"
+#include <string.h>
+
+#define EUI64_SIZE 8
+
+#define CACHE_SLOT_NONE           0xFF
+#define ADDRESS_TABLE_INDEX_NONE  0xFF
+
+// The address table size is only known at runtime, but its index is a uint8_t
+#define MAX_ADDRESS_TABLE_SIZE 256
+
+extern uint8_t sli_zigbee_address_table_size;
+
+_Static_assert(XNCP_ADDRESS_CACHE_SIZE < CACHE_SLOT_NONE, "Address cache is too large");
+
+typedef struct {
+    uint8_t eui64[EUI64_SIZE];
+    uint8_t index;
+    bool extended_timeout;
+    uint32_t last_used;
+} CachedAddress;
+
+static CachedAddress cache[XNCP_ADDRESS_CACHE_SIZE];
+static uint8_t cache_count;
+static uint32_t cache_clock;
+
+// CLOCK reference bits, one per address table entry
+static uint8_t referenced[MAX_ADDRESS_TABLE_SIZE / 8];
+static uint8_t clock_hand;
+
+static AddressCacheStats stats;
+
+static void set_referenced(uint8_t index)
+{
+    referenced[index / 8] |= (uint8_t)(1 << (index % 8));
+}
+
+// Clears the reference bit of `index`, returning its previous state
+static bool test_and_clear_referenced(uint8_t index)
+{
+    uint8_t mask = (uint8_t)(1 << (index % 8));
+    bool was_set = (referenced[index / 8] & mask) != 0;
+    referenced[index / 8] &= (uint8_t)~mask;
+    return was_set;
+}
+
+static bool address_table_entry_matches(uint8_t index, const uint8_t *eui64)
+{
+    sl_802154_short_addr_t node_id;
+    sl_802154_long_addr_t entry_eui64;
+
+    if (sl_zigbee_get_address_table_info(index, &node_id, entry_eui64) != SL_STATUS_OK) {
+        return false;
+    }
+
+    return (node_id != SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID)
+           && (memcmp(entry_eui64, eui64, EUI64_SIZE) == 0);
+}
+
+static void cache_remove(uint8_t slot)
+{
+    cache[slot] = cache[--cache_count];
+}
+
+static void cache_put(const uint8_t *eui64, uint8_t index, bool extended_timeout)
+{
+    uint8_t slot = 0;
+
+    // Replace the stale entry for this EUI64 or index, if any
+    while ((slot < cache_count)
+           && (cache[slot].index != index)
+           && (memcmp(cache[slot].eui64, eui64, EUI64_SIZE) != 0)) {
+        slot++;
+    }
+
+    if (slot == cache_count) {
+        if (cache_count < XNCP_ADDRESS_CACHE_SIZE) {
+            cache_count++;
+        } else {
+            // Evict the least recently used cache entry. Compare ages relative to the
+            // current clock so a wrapping clock does not matter.
+            slot = 0;
+            for (uint8_t i = 1; i < cache_count; i++) {
+                if ((cache_clock - cache[i].last_used)
+                    > (cache_clock - cache[slot].last_used)) {
+                    slot = i;
+                }
+            }
+        }
+    }
+
+    memcpy(cache[slot].eui64, eui64, EUI64_SIZE);
+    cache[slot].index = index;
+    cache[slot].extended_timeout = extended_timeout;
+    cache[slot].last_used = cache_clock++;
+}
+
+// Returns the cache slot holding `eui64`, or CACHE_SLOT_NONE. Hits are marked as
+// recently used.
+static uint8_t cache_find(const uint8_t *eui64)
+{
+    for (uint8_t slot = 0; slot < cache_count; slot++) {
+        if (memcmp(cache[slot].eui64, eui64, EUI64_SIZE) == 0) {
+            cache[slot].last_used = cache_clock++;
+            set_referenced(cache[slot].index);
+            return slot;
+        }
+    }
+
+    return CACHE_SLOT_NONE;
+}
+
+static uint8_t address_table_find(const uint8_t *eui64)
+{
+    for (uint16_t index = 0; index < sli_zigbee_address_table_size; index++) {
+        if (address_table_entry_matches((uint8_t)index, eui64)) {
+            return (uint8_t)index;
+        }
+    }
+
+    return ADDRESS_TABLE_INDEX_NONE;
+}
+
+void address_cache_init(void)
+{
+    address_cache_clear();
+    address_cache_reset_stats();
+}
+
+void address_cache_clear(void)
+{
+    cache_count = 0;
+    cache_clock = 0;
+    clock_hand = 0;
+    memset(referenced, 0, sizeof(referenced));
+}
+
+static uint8_t find_victim(void)
+{
+    uint16_t size = sli_zigbee_address_table_size;
+
+    for (uint16_t index = 0; index < size; index++) {
+        sl_802154_short_addr_t node_id;
+        sl_802154_long_addr_t eui64;
+
+        if ((sl_zigbee_get_address_table_info((uint8_t)index, &node_id, eui64) == SL_STATUS_OK)
+            && (node_id == SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID)) {
+            return (uint8_t)index;
+        }
+    }
+
+    stats.evictions++;
+
+    // Two sweeps are enough: the first one clears every reference bit
+    for (uint16_t i = 0; i < 2 * size; i++) {
+        uint8_t index = clock_hand;
+        clock_hand = (uint8_t)((clock_hand + 1) % size);
+
+        if (!test_and_clear_referenced(index)) {
+            return index;
+        }
+    }
+
+    return clock_hand;
+}
+
+void address_cache_set_extended_timeout(uint8_t *eui64,
+                                        xncp_node_id_t node_id,
+                                        bool extended_timeout)
+{
+    stats.lookups++;
+
+    uint8_t slot = cache_find(eui64);
+
+    if (slot != CACHE_SLOT_NONE) {
+        stats.hits++;
+
+        if (cache[slot].extended_timeout != extended_timeout) {
+            // The wrapped setter updates the cached flag
+            sl_zigbee_set_extended_timeout(eui64, extended_timeout);
+        }
+        return;
+    }
+
+    uint8_t index = address_table_find(eui64);
+
+    if (index == ADDRESS_TABLE_INDEX_NONE) {
+        if (!extended_timeout) {
+            // Nodes without an address table entry already use the default timeout
+            return;
+        }
+
+        // New entries start without a reference so one-off destinations are the
+        // first to go again
+        index = find_victim();
+        test_and_clear_referenced(index);
+        sl_zigbee_set_address_table_info(index, eui64, node_id);
+        stats.inserts++;
+    } else {
+        set_referenced(index);
+    }
+
+    if ((sl_zigbee_get_extended_timeout(eui64) == SL_STATUS_OK) != extended_timeout) {
+        sl_zigbee_set_extended_timeout(eui64, extended_timeout);
+    }
+
+    cache_put(eui64, index, extended_timeout);
+}
+
+const AddressCacheStats* address_cache_get_stats(void)
+{
+    return &stats;
+}
+
+void address_cache_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+//------------------------------------------------------------------------------
+// Linker wrapped functions
+//------------------------------------------------------------------------------
+
+sl_status_t __real_sli_zigbee_stack_set_extended_timeout(sl_802154_long_addr_t remote_eui64,
+                                                         bool extended_timeout);
+sl_status_t __real_sli_zigbee_stack_set_address_table_info(uint8_t address_table_index,
+                                                           sl_802154_long_addr_t eui64,
+                                                           sl_802154_short_addr_t node_id);
+
+// Both the EZSP command and the XNCP end up here
+sl_status_t __wrap_sli_zigbee_stack_set_extended_timeout(sl_802154_long_addr_t remote_eui64,
+                                                         bool extended_timeout)
+{
+    sl_status_t status = __real_sli_zigbee_stack_set_extended_timeout(remote_eui64,
+                                                                      extended_timeout);
+
+    for (uint8_t slot = 0; slot < cache_count; slot++) {
+        if (memcmp(cache[slot].eui64, remote_eui64, EUI64_SIZE) == 0) {
+            if (status == SL_STATUS_OK) {
+                cache[slot].extended_timeout = extended_timeout;
+            } else {
+                cache_remove(slot);
+            }
+            break;
+        }
+    }
+
+    return status;
+}
+
+// Rewriting an entry drops whatever was cached for its index or its new EUI64, the
+// next lookup reads both back from the stack
+sl_status_t __wrap_sli_zigbee_stack_set_address_table_info(uint8_t address_table_index,
+                                                           sl_802154_long_addr_t eui64,
+                                                           sl_802154_short_addr_t node_id)
+{
+    for (uint8_t slot = 0; slot < cache_count;) {
+        if ((cache[slot].index == address_table_index)
+            || (memcmp(cache[slot].eui64, eui64, EUI64_SIZE) == 0)) {
+            cache_remove(slot);
+        } else {
+            slot++;
+        }
+    }
+
+    return __real_sli_zigbee_stack_set_address_table_info(address_table_index, eui64, node_id);
+}
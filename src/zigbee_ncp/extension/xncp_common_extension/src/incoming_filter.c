@@ -0,0 +1,237 @@
+/*
+ * incoming_filter.c
+ *
+ * Drops unwanted and duplicate incoming APS frames before they are sent to the host
+ *
+ * Devices often send the same attribute report over and over, e.g. when they report on
+ * a short interval or retry at the application level. Reports are fingerprinted
+ * without their ZCL sequence number and compared against the last one forwarded for
+ * the same sender, endpoint, cluster and (first) attribute. Only a repeat of that last
+ * report within the window is dropped, so a value that changes and changes back is
+ * always forwarded and the host never keeps a stale one. The window is not extended
+ * by the drop, so the host still sees a steady report at least once per window.
+ */
+
+#include "incoming_filter.h"
+
+#if XNCP_INCOMING_FILTER_ENABLED
+
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+#define ZCL_FRAME_CONTROL_FRAME_TYPE_MASK       0x03
+#define ZCL_FRAME_CONTROL_FRAME_TYPE_GLOBAL     0x00
+#define ZCL_FRAME_CONTROL_MANUFACTURER_SPECIFIC 0x04
+#define ZCL_REPORT_ATTRIBUTES_COMMAND_ID        0x0A
+
+typedef struct {
+    uint16_t profile_id;
+    uint16_t cluster_id;
+} DropRule;
+
+// Last report forwarded for one attribute of a device
+typedef struct {
+    uint32_t fingerprint;
+    uint32_t forwarded_ms;
+    xncp_node_id_t sender;
+    uint16_t cluster_id;
+    uint16_t attribute_id;
+    uint8_t endpoint;
+} RecentReport;
+
+typedef struct {
+    xncp_node_id_t sender;
+    uint16_t cluster_id;
+    uint16_t attribute_id;
+    uint8_t endpoint;
+} ReportKey;
+
+static DropRule rules[XNCP_INCOMING_FILTER_MAX_RULES];
+static uint8_t rule_count;
+
+static RecentReport recent_reports[XNCP_INCOMING_FILTER_DEDUP_SIZE];
+static uint8_t recent_report_count;
+static uint16_t dedup_window_ms;
+
+static IncomingFilterStats stats;
+
+static uint32_t now_ms(void)
+{
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint32_t)ms;
+}
+
+static bool matches_rule(const sl_zigbee_aps_frame_t *aps_frame)
+{
+    for (uint8_t i = 0; i < rule_count; i++) {
+        if ((rules[i].profile_id == aps_frame->profileId)
+            && ((rules[i].cluster_id == INCOMING_FILTER_ANY_CLUSTER)
+                || (rules[i].cluster_id == aps_frame->clusterId))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, uint8_t length)
+{
+    for (uint8_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+
+    return hash;
+}
+
+// Fingerprints a ZCL attribute report, skipping its sequence number, and fills in the
+// attribute of its first record. Returns false if the frame is not an attribute report.
+static bool fingerprint_report(const sl_zigbee_aps_frame_t *aps_frame,
+                               const uint8_t *message,
+                               uint8_t message_length,
+                               uint16_t *attribute_id,
+                               uint32_t *fingerprint)
+{
+    // frame_control(1) [manufacturer_code(2)] sequence(1) command_id(1) attribute_id(2) ...
+    if (message_length < 3) {
+        return false;
+    }
+
+    uint8_t frame_control = message[0];
+    uint8_t sequence_offset = (frame_control & ZCL_FRAME_CONTROL_MANUFACTURER_SPECIFIC) ? 3 : 1;
+
+    if (((frame_control & ZCL_FRAME_CONTROL_FRAME_TYPE_MASK) != ZCL_FRAME_CONTROL_FRAME_TYPE_GLOBAL)
+        || (message_length < sequence_offset + 4)
+        || (message[sequence_offset + 1] != ZCL_REPORT_ATTRIBUTES_COMMAND_ID)) {
+        return false;
+    }
+
+    *attribute_id = (uint16_t)(message[sequence_offset + 2] | (message[sequence_offset + 3] << 8));
+
+    const uint8_t header[6] = {
+        (uint8_t)(aps_frame->profileId >> 0), (uint8_t)(aps_frame->profileId >> 8),
+        (uint8_t)(aps_frame->clusterId >> 0), (uint8_t)(aps_frame->clusterId >> 8),
+        aps_frame->sourceEndpoint, aps_frame->destinationEndpoint
+    };
+
+    uint32_t hash = 2166136261UL;  // FNV-1a
+    hash = fnv1a(hash, header, sizeof(header));
+    hash = fnv1a(hash, message, sequence_offset);
+    hash = fnv1a(hash, message + sequence_offset + 1, message_length - sequence_offset - 1);
+
+    *fingerprint = hash;
+    return true;
+}
+
+// Returns true if the report repeats the last one forwarded for its key within the
+// window, otherwise remembers it as the last one
+static bool is_duplicate_report(const ReportKey *key, uint32_t fingerprint)
+{
+    uint32_t now = now_ms();
+    uint8_t oldest = 0;
+
+    for (uint8_t i = 0; i < recent_report_count; i++) {
+        RecentReport *report = &recent_reports[i];
+
+        if ((report->sender == key->sender)
+            && (report->endpoint == key->endpoint)
+            && (report->cluster_id == key->cluster_id)
+            && (report->attribute_id == key->attribute_id)) {
+            if ((report->fingerprint == fingerprint)
+                && ((now - report->forwarded_ms) < dedup_window_ms)) {
+                return true;
+            }
+
+            // Changed or expired, forward it and restart the window
+            report->fingerprint = fingerprint;
+            report->forwarded_ms = now;
+            return false;
+        }
+
+        if ((now - report->forwarded_ms) > (now - recent_reports[oldest].forwarded_ms)) {
+            oldest = i;
+        }
+    }
+
+    uint8_t slot = (recent_report_count < XNCP_INCOMING_FILTER_DEDUP_SIZE)
+                   ? recent_report_count++
+                   : oldest;
+
+    recent_reports[slot].sender = key->sender;
+    recent_reports[slot].endpoint = key->endpoint;
+    recent_reports[slot].cluster_id = key->cluster_id;
+    recent_reports[slot].attribute_id = key->attribute_id;
+    recent_reports[slot].fingerprint = fingerprint;
+    recent_reports[slot].forwarded_ms = now;
+    return false;
+}
+
+void incoming_filter_init(void)
+{
+    incoming_filter_clear_rules();
+    incoming_filter_set_dedup_window(0);
+    incoming_filter_reset_stats();
+}
+
+void incoming_filter_clear_rules(void)
+{
+    rule_count = 0;
+}
+
+bool incoming_filter_add_rule(uint16_t profile_id, uint16_t cluster_id)
+{
+    if (rule_count == XNCP_INCOMING_FILTER_MAX_RULES) {
+        return false;
+    }
+
+    rules[rule_count].profile_id = profile_id;
+    rules[rule_count].cluster_id = cluster_id;
+    rule_count++;
+    return true;
+}
+
+void incoming_filter_set_dedup_window(uint16_t window_ms)
+{
+    dedup_window_ms = window_ms;
+    recent_report_count = 0;
+}
+
+bool incoming_filter_accepts(xncp_node_id_t sender,
+                             const sl_zigbee_aps_frame_t *aps_frame,
+                             const uint8_t *message,
+                             uint8_t message_length)
+{
+    if (matches_rule(aps_frame)) {
+        stats.dropped_by_rule++;
+        return false;
+    }
+
+    ReportKey key = {
+        .sender = sender,
+        .cluster_id = aps_frame->clusterId,
+        .endpoint = aps_frame->sourceEndpoint,
+    };
+    uint32_t fingerprint;
+
+    if ((dedup_window_ms != 0)
+        && fingerprint_report(aps_frame, message, message_length, &key.attribute_id, &fingerprint)
+        && is_duplicate_report(&key, fingerprint)) {
+        stats.dropped_duplicates++;
+        return false;
+    }
+
+    stats.passed++;
+    return true;
+}
+
+const IncomingFilterStats* incoming_filter_get_stats(void)
+{
+    return &stats;
+}
+
+void incoming_filter_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+#endif // XNCP_INCOMING_FILTER_ENABLED
@@ -0,0 +1,429 @@
+/*
+ * manual_source_route.c
+ *
+ * Manual source route table, indexed by destination node ID
+ *
+ * Lookups run in the `override_append_source_route` callback for every outgoing
+ * unicast, so routes are found through an open addressing hash index (linear probing
+ * with backward shift deletion) instead of scanning the table. Installed routes are
+ * kept on an LRU list, which picks the eviction victim once the table is full.
+ *
+ * Most routes have zero to three relays, so instead of reserving room for
+ * XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT relays in every entry, relays live in a shared pool
+ * of fixed size chunks that are linked together per route.
+ *
+ * Expiry times are kept in 16 bits, as seconds after a shared epoch. Installing a
+ * route whose expiry would not fit moves the epoch up to now, dropping the routes
+ * that expired in the meantime and rebasing the others.
+ */
+
+#include "manual_source_route.h"
+#include "memory_stats.h"
+#include "xncp_hash.h"
+#include "sl_sleeptimer.h"
+
+#define BUILD_UINT16(low, high) (((uint16_t)(low)) | ((uint16_t)(high) << 8))
+
+#define ROUTE_INDEX_NONE  0xFFFF
+#define CHUNK_INDEX_NONE  0xFFFF
+
+#define RELAYS_PER_CHUNK  3
+#define CHUNKS_FOR_RELAYS(n)  (((n) + RELAYS_PER_CHUNK - 1) / RELAYS_PER_CHUNK)
+
+// Keep the index at most half full so probe sequences stay short
+#define ROUTE_HASH_SIZE   (2 * XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE)
+
+typedef struct {
+    uint16_t relays[RELAYS_PER_CHUNK];
+    uint16_t next;
+} RelayChunk;
+
+_Static_assert(XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE >= CHUNKS_FOR_RELAYS(XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT),
+               "Relay pool cannot hold a single maximum length source route");
+
+// Every byte here is paid for XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE times
+_Static_assert(sizeof(ManualSourceRoute) <= 14, "ManualSourceRoute grew, check its SRAM cost");
+
+static ManualSourceRoute routes[XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE];
+
+static RelayChunk relay_pool[XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE];
+static uint16_t free_chunk_head;
+static uint16_t free_chunk_count;
+
+static uint16_t route_count;
+
+// Hash slot -> index into `routes`
+static uint16_t route_hash[ROUTE_HASH_SIZE];
+
+// Most and least recently used routes
+static uint16_t lru_head;
+static uint16_t lru_tail;
+
+// Unused routes, chained through `lru_next`
+static uint16_t free_head;
+
+// Time that route `expiry_s` values count from, in seconds since boot
+static uint32_t expiry_epoch_s;
+
+static uint16_t hash_slot(xncp_node_id_t destination)
+{
+    return xncp_hash_u16(destination, ROUTE_HASH_SIZE);
+}
+
+static uint32_t now_s(void)
+{
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint32_t)(ms / 1000);
+}
+
+static bool is_expired(const ManualSourceRoute *route, uint32_t now)
+{
+    return (route->expiry_s != 0) && ((now - expiry_epoch_s) >= route->expiry_s);
+}
+
+static uint16_t route_index(const ManualSourceRoute *route)
+{
+    return (uint16_t)(route - routes);
+}
+
+static void lru_unlink(uint16_t index)
+{
+    ManualSourceRoute *route = &routes[index];
+
+    if (route->lru_prev != ROUTE_INDEX_NONE) {
+        routes[route->lru_prev].lru_next = route->lru_next;
+    } else {
+        lru_head = route->lru_next;
+    }
+
+    if (route->lru_next != ROUTE_INDEX_NONE) {
+        routes[route->lru_next].lru_prev = route->lru_prev;
+    } else {
+        lru_tail = route->lru_prev;
+    }
+}
+
+static void lru_push_head(uint16_t index)
+{
+    ManualSourceRoute *route = &routes[index];
+
+    route->lru_prev = ROUTE_INDEX_NONE;
+    route->lru_next = lru_head;
+
+    if (lru_head != ROUTE_INDEX_NONE) {
+        routes[lru_head].lru_prev = index;
+    } else {
+        lru_tail = index;
+    }
+
+    lru_head = index;
+}
+
+// Marks a route as most recently used, protecting it from eviction
+static void lru_touch(ManualSourceRoute *route)
+{
+    uint16_t index = route_index(route);
+
+    if (lru_head != index) {
+        lru_unlink(index);
+        lru_push_head(index);
+    }
+}
+
+// Returns the hash slot holding `destination`, or ROUTE_INDEX_NONE
+static uint16_t hash_find(xncp_node_id_t destination)
+{
+    uint16_t slot = hash_slot(destination);
+
+    while (route_hash[slot] != ROUTE_INDEX_NONE) {
+        if (routes[route_hash[slot]].destination == destination) {
+            return slot;
+        }
+
+        slot = (slot + 1) % ROUTE_HASH_SIZE;
+    }
+
+    return ROUTE_INDEX_NONE;
+}
+
+static void hash_insert(uint16_t index)
+{
+    uint16_t slot = hash_slot(routes[index].destination);
+
+    while (route_hash[slot] != ROUTE_INDEX_NONE) {
+        slot = (slot + 1) % ROUTE_HASH_SIZE;
+    }
+
+    route_hash[slot] = index;
+}
+
+// Backward shift deletion: pull later members of the probe run into the hole so that
+// lookups never need tombstones
+static void hash_delete(uint16_t slot)
+{
+    uint16_t hole = slot;
+    uint16_t next = slot;
+
+    while (true) {
+        next = (next + 1) % ROUTE_HASH_SIZE;
+
+        if (route_hash[next] == ROUTE_INDEX_NONE) {
+            break;
+        }
+
+        uint16_t home = hash_slot(routes[route_hash[next]].destination);
+
+        // Entries whose home slot lies cyclically within (hole, next] stay put
+        bool stays = (hole <= next) ? ((hole < home) && (home <= next))
+                                    : ((hole < home) || (home <= next));
+        if (stays) {
+            continue;
+        }
+
+        route_hash[hole] = route_hash[next];
+        hole = next;
+    }
+
+    route_hash[hole] = ROUTE_INDEX_NONE;
+}
+
+static void free_chunks(uint16_t chunk)
+{
+    while (chunk != CHUNK_INDEX_NONE) {
+        uint16_t next = relay_pool[chunk].next;
+
+        relay_pool[chunk].next = free_chunk_head;
+        free_chunk_head = chunk;
+        free_chunk_count++;
+
+        chunk = next;
+    }
+}
+
+// The caller guarantees that enough chunks are free
+static uint16_t alloc_chunks(uint8_t count)
+{
+    uint16_t head = CHUNK_INDEX_NONE;
+
+    while (count-- > 0) {
+        uint16_t chunk = free_chunk_head;
+
+        free_chunk_head = relay_pool[chunk].next;
+        free_chunk_count--;
+
+        relay_pool[chunk].next = head;
+        head = chunk;
+    }
+
+    return head;
+}
+
+static void update_memory_stats(void)
+{
+    memory_stats_update(MEMORY_POOL_MANUAL_SOURCE_ROUTE_TABLE, route_count);
+    memory_stats_update(MEMORY_POOL_MANUAL_SOURCE_ROUTE_RELAYS,
+                        XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE - free_chunk_count);
+}
+
+void manual_source_route_init(void)
+{
+    for (uint16_t i = 0; i < ROUTE_HASH_SIZE; i++) {
+        route_hash[i] = ROUTE_INDEX_NONE;
+    }
+
+    for (uint16_t i = 0; i < XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE; i++) {
+        routes[i].lru_next = (i + 1 < XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE) ? (i + 1) : ROUTE_INDEX_NONE;
+    }
+
+    for (uint16_t i = 0; i < XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE; i++) {
+        relay_pool[i].next = (i + 1 < XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE) ? (i + 1) : CHUNK_INDEX_NONE;
+    }
+
+    free_head = 0;
+    lru_head = ROUTE_INDEX_NONE;
+    lru_tail = ROUTE_INDEX_NONE;
+
+    free_chunk_head = 0;
+    free_chunk_count = XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE;
+
+    route_count = 0;
+    expiry_epoch_s = now_s();
+    update_memory_stats();
+}
+
+void manual_source_route_clear(void)
+{
+    manual_source_route_init();
+}
+
+ManualSourceRoute* manual_source_route_get(xncp_node_id_t destination)
+{
+    uint16_t slot = hash_find(destination);
+
+    if (slot == ROUTE_INDEX_NONE) {
+        return NULL;
+    }
+
+    ManualSourceRoute *route = &routes[route_hash[slot]];
+
+    if (is_expired(route, now_s())) {
+        manual_source_route_remove(route);
+        return NULL;
+    }
+
+    return route;
+}
+
+uint16_t manual_source_route_get_ttl(const ManualSourceRoute *route)
+{
+    uint32_t now = now_s();
+
+    if ((route->expiry_s == 0) || is_expired(route, now)) {
+        return 0;
+    }
+
+    return (uint16_t)(route->expiry_s - (now - expiry_epoch_s));
+}
+
+void manual_source_route_remove(ManualSourceRoute *route)
+{
+    uint16_t index = route_index(route);
+
+    hash_delete(hash_find(route->destination));
+    lru_unlink(index);
+    free_chunks(route->first_chunk);
+
+    route->lru_next = free_head;
+    free_head = index;
+
+    route_count--;
+    update_memory_stats();
+}
+
+uint8_t manual_source_route_get_relays(const ManualSourceRoute *route,
+                                       uint16_t relays[XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT])
+{
+    uint16_t chunk = route->first_chunk;
+
+    for (uint8_t i = 0; i < route->num_relays; i++) {
+        relays[i] = relay_pool[chunk].relays[i % RELAYS_PER_CHUNK];
+
+        if ((i % RELAYS_PER_CHUNK) == (RELAYS_PER_CHUNK - 1)) {
+            chunk = relay_pool[chunk].next;
+        }
+    }
+
+    return route->num_relays;
+}
+
+// Moves the expiry epoch up to `now`, so that any TTL fits into `expiry_s` again
+static void rebase_expiry(uint32_t now)
+{
+    uint32_t elapsed = now - expiry_epoch_s;
+    uint16_t index = lru_head;
+
+    while (index != ROUTE_INDEX_NONE) {
+        ManualSourceRoute *route = &routes[index];
+        index = route->lru_next;
+
+        if (route->expiry_s == 0) {
+            continue;
+        }
+
+        if (route->expiry_s <= elapsed) {
+            manual_source_route_remove(route);
+        } else {
+            route->expiry_s -= (uint16_t)elapsed;
+        }
+    }
+
+    expiry_epoch_s = now;
+}
+
+void manual_source_route_use(ManualSourceRoute *route)
+{
+    if (route->hits < UINT8_MAX) {
+        route->hits++;
+    }
+
+    if (route->remaining_uses != 0) {
+        route->remaining_uses--;
+
+        if (route->remaining_uses == 0) {
+            manual_source_route_remove(route);
+            return;
+        }
+    }
+
+    lru_touch(route);
+}
+
+void manual_source_route_install(xncp_node_id_t node_id,
+                                 const uint8_t *relay_bytes,
+                                 uint8_t num_relays,
+                                 uint8_t max_uses,
+                                 uint16_t ttl_s)
+{
+    ManualSourceRoute *route = manual_source_route_get(node_id);
+
+    if (route != NULL) {
+        free_chunks(route->first_chunk);
+        route->first_chunk = CHUNK_INDEX_NONE;
+        lru_touch(route);
+    } else {
+        if (free_head == ROUTE_INDEX_NONE) {
+            memory_stats_record_full(MEMORY_POOL_MANUAL_SOURCE_ROUTE_TABLE);
+            manual_source_route_remove(&routes[lru_tail]);
+        }
+
+        uint16_t index = free_head;
+        route = &routes[index];
+        free_head = route->lru_next;
+
+        route->destination = node_id;
+        route->first_chunk = CHUNK_INDEX_NONE;
+        hash_insert(index);
+        lru_push_head(index);
+        route_count++;
+    }
+
+    // `route` is now the most recently used one, so it is never picked here
+    uint8_t num_chunks = CHUNKS_FOR_RELAYS(num_relays);
+
+    while (free_chunk_count < num_chunks) {
+        memory_stats_record_full(MEMORY_POOL_MANUAL_SOURCE_ROUTE_RELAYS);
+        manual_source_route_remove(&routes[lru_tail]);
+    }
+
+    route->first_chunk = alloc_chunks(num_chunks);
+    update_memory_stats();
+    route->num_relays = num_relays;
+    route->remaining_uses = max_uses;
+    route->hits = 0;
+    route->failures = 0;
+    route->expiry_s = 0;
+
+    if (ttl_s != 0) {
+        uint32_t now = now_s();
+
+        if ((now - expiry_epoch_s) + ttl_s > UINT16_MAX) {
+            rebase_expiry(now);
+        }
+
+        route->expiry_s = (uint16_t)((now - expiry_epoch_s) + ttl_s);
+    }
+
+    // Relays are stored in over-the-air order, which is the reverse of the host's
+    uint16_t chunk = route->first_chunk;
+
+    for (uint8_t i = 0; i < num_relays; i++) {
+        uint8_t j = num_relays - i - 1;
+        relay_pool[chunk].relays[i % RELAYS_PER_CHUNK] = BUILD_UINT16(relay_bytes[2 * j + 0],
+                                                                      relay_bytes[2 * j + 1]);
+
+        if ((i % RELAYS_PER_CHUNK) == (RELAYS_PER_CHUNK - 1)) {
+            chunk = relay_pool[chunk].next;
+        }
+    }
+}
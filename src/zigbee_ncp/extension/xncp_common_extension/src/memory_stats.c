@@ -0,0 +1,227 @@
+/*
+ * memory_stats.c
+ *
+ * Current and peak usage of stack pools and buffers (XNCP_FEATURE_MEMORY_STATS)
+ *
+ * Table sizes in the manifests were picked generously and never revisited. Tracking
+ * how full each pool gets under real load lets them be sized per product.
+ *
+ * The stack only exposes usage for some of them, the rest is followed from the events
+ * that allocate and free entries:
+ *  - The packet buffer heap and the stack's source route table are polled every main
+ *    loop pass, and right after a unicast is queued, when the heap is fullest.
+ *  - APS unicast slots are counted from queueing to the message sent callback. Unicasts
+ *    the stack originates internally are missed.
+ *  - Broadcast table entries are estimated from the APS broadcasts and multicasts the
+ *    stack sends or delivers, each held for the broadcast table timeout. NWK level
+ *    broadcasts such as route requests are not visible, so this is a lower bound.
+ */
+
+#include "memory_stats.h"
+
+sl_status_t __real_sli_zigbee_stack_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                                 uint16_t indexOrDestination,
+                                                 sl_zigbee_aps_frame_t *apsFrame,
+                                                 uint16_t messageTag,
+                                                 uint8_t messageLength,
+                                                 const uint8_t *message,
+                                                 uint8_t *apsSequence);
+
+#if XNCP_MEMORY_STATS_ENABLED
+
+#include "buffer_manager/buffer-management.h"
+#include "stack/include/source-route.h"
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+// Entries are kept for the broadcast delivery time, the stack default is 20 s
+#ifndef SL_ZIGBEE_BROADCAST_TABLE_TIMEOUT_QS
+#define SL_ZIGBEE_BROADCAST_TABLE_TIMEOUT_QS (20 * 4)
+#endif
+
+// Broadcast timestamps, in quarter seconds. Indices wrap with uint8_t arithmetic.
+#define BROADCAST_HISTORY_SIZE 256
+
+// External references to EmberZNet table sizes
+extern uint8_t sli_zigbee_aps_unicast_message_count;
+extern uint8_t sli_zigbee_broadcast_table_size;
+
+static MemoryPoolStats pools[MEMORY_POOL_COUNT];
+
+static uint16_t broadcast_history[BROADCAST_HISTORY_SIZE];
+static uint8_t broadcast_oldest;
+static uint16_t broadcast_count;
+
+static uint16_t now_qs(void)
+{
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint16_t)(ms / 250);
+}
+
+static void add_saturating(uint16_t *value, size_t amount)
+{
+    *value = (amount > (size_t)(UINT16_MAX - *value)) ? UINT16_MAX : (uint16_t)(*value + amount);
+}
+
+static void sample_heap(void)
+{
+    uint16_t used = sl_legacy_buffer_manager_buffer_bytes_used();
+
+    memory_stats_set_capacity(MEMORY_POOL_PACKET_BUFFER_HEAP,
+                              used + sl_legacy_buffer_manager_buffer_bytes_remaining());
+    memory_stats_update(MEMORY_POOL_PACKET_BUFFER_HEAP, used);
+}
+
+static void expire_broadcasts(void)
+{
+    uint16_t now = now_qs();
+
+    while ((broadcast_count > 0)
+           && ((uint16_t)(now - broadcast_history[broadcast_oldest]) >= SL_ZIGBEE_BROADCAST_TABLE_TIMEOUT_QS)) {
+        broadcast_oldest++;
+        broadcast_count--;
+    }
+
+    memory_stats_update(MEMORY_POOL_BROADCAST_TABLE, broadcast_count);
+}
+
+void memory_stats_init(void)
+{
+    memset(pools, 0, sizeof(pools));
+    broadcast_count = 0;
+
+    memory_stats_set_capacity(MEMORY_POOL_APS_UNICAST, sli_zigbee_aps_unicast_message_count);
+    memory_stats_set_capacity(MEMORY_POOL_BROADCAST_TABLE, sli_zigbee_broadcast_table_size);
+    memory_stats_set_capacity(MEMORY_POOL_MANUAL_SOURCE_ROUTE_TABLE, XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE);
+    memory_stats_set_capacity(MEMORY_POOL_MANUAL_SOURCE_ROUTE_RELAYS, XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE);
+
+    memory_stats_sample_stack();
+}
+
+void memory_stats_sample_stack(void)
+{
+    sample_heap();
+
+    memory_stats_set_capacity(MEMORY_POOL_SOURCE_ROUTE_TABLE,
+                              sl_zigbee_get_source_route_table_total_size());
+    memory_stats_update(MEMORY_POOL_SOURCE_ROUTE_TABLE,
+                        sl_zigbee_get_source_route_table_filled_size());
+}
+
+void memory_stats_process_action(void)
+{
+    memory_stats_sample_stack();
+    expire_broadcasts();
+}
+
+void memory_stats_set_capacity(MemoryPool pool, uint16_t capacity)
+{
+    pools[pool].capacity = capacity;
+}
+
+void memory_stats_update(MemoryPool pool, uint16_t current)
+{
+    pools[pool].current = current;
+
+    if (current > pools[pool].high_water) {
+        pools[pool].high_water = current;
+    }
+}
+
+void memory_stats_record_full(MemoryPool pool)
+{
+    add_saturating(&pools[pool].full_count, 1);
+}
+
+void memory_stats_aps_unicast_queued(void)
+{
+    uint16_t current = pools[MEMORY_POOL_APS_UNICAST].current;
+
+    add_saturating(&current, 1);
+    memory_stats_update(MEMORY_POOL_APS_UNICAST, current);
+}
+
+void memory_stats_aps_unicast_completed(void)
+{
+    // Completions of unicasts that were never counted must not underflow
+    if (pools[MEMORY_POOL_APS_UNICAST].current > 0) {
+        pools[MEMORY_POOL_APS_UNICAST].current--;
+    }
+}
+
+void memory_stats_broadcast_seen(void)
+{
+    // The history only runs out when the table timeout is unusually long
+    if (broadcast_count == BROADCAST_HISTORY_SIZE) {
+        broadcast_oldest++;
+        broadcast_count--;
+    }
+
+    broadcast_history[(uint8_t)(broadcast_oldest + broadcast_count)] = now_qs();
+    broadcast_count++;
+
+    expire_broadcasts();
+}
+
+const MemoryPoolStats* memory_stats_get(MemoryPool pool)
+{
+    return &pools[pool];
+}
+
+void memory_stats_reset(void)
+{
+    for (uint8_t i = 0; i < MEMORY_POOL_COUNT; i++) {
+        pools[i].high_water = pools[i].current;
+        pools[i].full_count = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Linker wrapped functions
+//------------------------------------------------------------------------------
+
+// Both the EZSP command and XNCP sends end up here
+sl_status_t __wrap_sli_zigbee_stack_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                                 uint16_t indexOrDestination,
+                                                 sl_zigbee_aps_frame_t *apsFrame,
+                                                 uint16_t messageTag,
+                                                 uint8_t messageLength,
+                                                 const uint8_t *message,
+                                                 uint8_t *apsSequence)
+{
+    sl_status_t status = __real_sli_zigbee_stack_send_unicast(type, indexOrDestination, apsFrame,
+                                                              messageTag, messageLength, message,
+                                                              apsSequence);
+
+    if (status == SL_STATUS_OK) {
+        memory_stats_aps_unicast_queued();
+        sample_heap();
+    } else if (status == SL_STATUS_ZIGBEE_MAX_MESSAGE_LIMIT_REACHED) {
+        memory_stats_record_full(MEMORY_POOL_APS_UNICAST);
+    }
+
+    return status;
+}
+
+#else
+
+void memory_stats_process_action(void)
+{
+}
+
+// The linker wrap is always in place, so it stays as a plain forward
+sl_status_t __wrap_sli_zigbee_stack_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                                 uint16_t indexOrDestination,
+                                                 sl_zigbee_aps_frame_t *apsFrame,
+                                                 uint16_t messageTag,
+                                                 uint8_t messageLength,
+                                                 const uint8_t *message,
+                                                 uint8_t *apsSequence)
+{
+    return __real_sli_zigbee_stack_send_unicast(type, indexOrDestination, apsFrame,
+                                                messageTag, messageLength, message,
+                                                apsSequence);
+}
+
+#endif // XNCP_MEMORY_STATS_ENABLED
@@ -0,0 +1,113 @@
+/*
+ * multicast_filter.c
+ *
+ * Set of multicast group IDs forwarded to the host
+ *
+ * Membership is checked for every incoming group frame, so groups are kept in an open
+ * addressing hash set with linear probing. Groups are only ever removed all at once,
+ * which keeps the set free of tombstones.
+ */
+
+#include "multicast_filter.h"
+#include "xncp_hash.h"
+#include <string.h>
+
+// 0xFFFF is not a valid group ID (0xFFF8-0xFFFF are reserved), use it for empty slots
+#define GROUP_ID_NONE 0xFFFF
+
+// Keep the set at most half full so probe sequences stay short
+#define GROUP_HASH_SIZE (2 * XNCP_MULTICAST_FILTER_SIZE)
+
+static xncp_multicast_id_t groups[GROUP_HASH_SIZE];
+static uint16_t group_count;
+static bool filter_enabled;
+
+static MulticastFilterStats stats;
+
+static uint16_t hash_slot(xncp_multicast_id_t group_id)
+{
+    return xncp_hash_u16(group_id, GROUP_HASH_SIZE);
+}
+
+bool multicast_filter_contains(xncp_multicast_id_t group_id)
+{
+    for (uint16_t slot = hash_slot(group_id);; slot = (slot + 1) % GROUP_HASH_SIZE) {
+        if (groups[slot] == group_id) {
+            return true;
+        } else if (groups[slot] == GROUP_ID_NONE) {
+            return false;
+        }
+    }
+}
+
+void multicast_filter_init(void)
+{
+    filter_enabled = false;
+    multicast_filter_clear();
+    multicast_filter_reset_stats();
+}
+
+void multicast_filter_set_enabled(bool enabled)
+{
+    filter_enabled = enabled;
+}
+
+bool multicast_filter_is_enabled(void)
+{
+    return filter_enabled;
+}
+
+void multicast_filter_clear(void)
+{
+    for (uint16_t slot = 0; slot < GROUP_HASH_SIZE; slot++) {
+        groups[slot] = GROUP_ID_NONE;
+    }
+
+    group_count = 0;
+}
+
+bool multicast_filter_add(xncp_multicast_id_t group_id)
+{
+    if (group_id == GROUP_ID_NONE) {
+        return false;
+    } else if (multicast_filter_contains(group_id)) {
+        return true;
+    }
+
+    if (group_count == XNCP_MULTICAST_FILTER_SIZE) {
+        return false;
+    }
+
+    uint16_t slot = hash_slot(group_id);
+    while (groups[slot] != GROUP_ID_NONE) {
+        slot = (slot + 1) % GROUP_HASH_SIZE;
+    }
+
+    groups[slot] = group_id;
+    group_count++;
+    return true;
+}
+
+uint16_t multicast_filter_get_count(void)
+{
+    return group_count;
+}
+
+void multicast_filter_record(bool accepted)
+{
+    if (accepted) {
+        stats.accepted++;
+    } else {
+        stats.rejected++;
+    }
+}
+
+const MulticastFilterStats* multicast_filter_get_stats(void)
+{
+    return &stats;
+}
+
+void multicast_filter_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,202 @@
+/*
+ * neighbor_stats.c
+ *
+ * Per-neighbor link quality and MAC delivery statistics
+ *
+ * The host used to rebuild link quality from the last hop LQI/RSSI of every incoming
+ * message, which costs a UART frame per packet. Samples are aggregated here instead and
+ * read as a snapshot. The table has one entry per neighbor table slot; when it is full
+ * the neighbor that was heard from least recently is replaced in place, so indices stay
+ * stable while the host pages through it.
+ */
+
+#include "neighbor_stats.h"
+
+#if XNCP_NEIGHBOR_STATS_ENABLED
+
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+#define NODE_ID_NONE 0xFFFF
+
+// Averages move 1/8 of the way towards every new sample
+#define AVERAGE_SHIFT 3
+
+static NeighborStats table[XNCP_NEIGHBOR_STATS_SIZE];
+
+static uint32_t now_ms(void)
+{
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint32_t)ms;
+}
+
+static void increment(uint16_t *counter)
+{
+    if (*counter < UINT16_MAX) {
+        (*counter)++;
+    }
+}
+
+static bool is_stack_neighbor(xncp_node_id_t node_id)
+{
+    uint8_t count = sl_zigbee_neighbor_count();
+
+    for (uint8_t i = 0; i < count; i++) {
+        sl_zigbee_neighbor_table_entry_t entry;
+
+        if ((sl_zigbee_get_neighbor(i, &entry) == SL_STATUS_OK) && (entry.short_id == node_id)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static NeighborStats* find(xncp_node_id_t node_id)
+{
+    for (uint8_t i = 0; i < XNCP_NEIGHBOR_STATS_SIZE; i++) {
+        if (table[i].node_id == node_id) {
+            return &table[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void reset_entry(NeighborStats *entry)
+{
+    entry->rssi_min = INT8_MAX;
+    entry->rssi_max = INT8_MIN;
+    entry->lqi_min = UINT8_MAX;
+    entry->lqi_max = 0;
+    entry->rx_packets = 0;
+    entry->tx_packets = 0;
+    entry->mac_retries = 0;
+    entry->tx_failures = 0;
+}
+
+static NeighborStats* add(xncp_node_id_t node_id)
+{
+    uint32_t now = now_ms();
+    NeighborStats *entry = NULL;
+
+    for (uint8_t i = 0; i < XNCP_NEIGHBOR_STATS_SIZE; i++) {
+        if (table[i].node_id == NODE_ID_NONE) {
+            entry = &table[i];
+            break;
+        }
+
+        // Compare ages relative to now so a wrapping clock does not matter
+        if ((entry == NULL) || ((now - table[i].last_seen_ms) > (now - entry->last_seen_ms))) {
+            entry = &table[i];
+        }
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->node_id = node_id;
+    reset_entry(entry);
+    return entry;
+}
+
+// Returns the entry of a node known to be a neighbor, adding it if needed. Only frames
+// the neighbor sent or acknowledged count as hearing from it; new entries that were
+// not heard from are the first to be replaced.
+static NeighborStats* get_or_add(xncp_node_id_t node_id, bool heard)
+{
+    NeighborStats *entry = find(node_id);
+
+    if (entry == NULL) {
+        entry = add(node_id);
+    }
+
+    if (heard) {
+        entry->last_seen_ms = now_ms();
+    }
+
+    return entry;
+}
+
+void neighbor_stats_init(void)
+{
+    neighbor_stats_clear();
+}
+
+void neighbor_stats_clear(void)
+{
+    for (uint8_t i = 0; i < XNCP_NEIGHBOR_STATS_SIZE; i++) {
+        table[i].node_id = NODE_ID_NONE;
+    }
+}
+
+void neighbor_stats_record_rx(xncp_node_id_t node_id, int8_t rssi, uint8_t lqi)
+{
+    if ((find(node_id) == NULL) && !is_stack_neighbor(node_id)) {
+        return;
+    }
+
+    NeighborStats *entry = get_or_add(node_id, true);
+    int16_t rssi_sample = (int16_t)(rssi * NEIGHBOR_STATS_AVERAGE_SCALE);
+    uint16_t lqi_sample = (uint16_t)(lqi * NEIGHBOR_STATS_AVERAGE_SCALE);
+
+    if (!entry->has_average) {
+        // Seed the averages with the first sample instead of converging from zero
+        entry->rssi_average = rssi_sample;
+        entry->lqi_average = lqi_sample;
+        entry->has_average = true;
+    } else {
+        entry->rssi_average += (rssi_sample - entry->rssi_average) / (1 << AVERAGE_SHIFT);
+        entry->lqi_average += ((int32_t)lqi_sample - entry->lqi_average) / (1 << AVERAGE_SHIFT);
+    }
+
+    if (rssi < entry->rssi_min) {
+        entry->rssi_min = rssi;
+    }
+
+    if (rssi > entry->rssi_max) {
+        entry->rssi_max = rssi;
+    }
+
+    if (lqi < entry->lqi_min) {
+        entry->lqi_min = lqi;
+    }
+
+    if (lqi > entry->lqi_max) {
+        entry->lqi_max = lqi;
+    }
+
+    increment(&entry->rx_packets);
+}
+
+void neighbor_stats_record_tx_success(xncp_node_id_t node_id)
+{
+    increment(&get_or_add(node_id, true)->tx_packets);
+}
+
+void neighbor_stats_record_mac_retry(xncp_node_id_t node_id)
+{
+    increment(&get_or_add(node_id, false)->mac_retries);
+}
+
+void neighbor_stats_record_tx_failure(xncp_node_id_t node_id)
+{
+    increment(&get_or_add(node_id, false)->tx_failures);
+}
+
+const NeighborStats* neighbor_stats_get(uint8_t index)
+{
+    if ((index >= XNCP_NEIGHBOR_STATS_SIZE) || (table[index].node_id == NODE_ID_NONE)) {
+        return NULL;
+    }
+
+    return &table[index];
+}
+
+void neighbor_stats_reset(uint8_t index)
+{
+    if (neighbor_stats_get(index) != NULL) {
+        reset_entry(&table[index]);
+    }
+}
+
+#endif // XNCP_NEIGHBOR_STATS_ENABLED
@@ -0,0 +1,136 @@
+/*
+ * route_table_journal.c
+ *
+ * Journal of route table changes, used for incremental route table sync
+ *
+ * The stack updates the route table without notifying us, so changes are found by
+ * diffing the table against a shadow copy whenever the journal is updated, which
+ * happens when the host asks for changes or for the route table generation. It is
+ * the only change detection for the route table.
+ *
+ * Changes are therefore coalesced: an entry that changed several times between two
+ * updates is journaled once, from its state at the previous update to the current
+ * one. Each changed entry is appended to a ring buffer under the next sequence
+ * number; once the ring wraps, hosts that fell behind have to resync the whole table.
+ *
+ * Entries the host writes itself are taken into the shadow copy without being
+ * journaled, so restoring a whole table does not overflow the ring.
+ */
+
+#include "route_table_journal.h"
+
+#if XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
+// The NCP manifests set the route table size through `c_defines`. Without it, cover
+// every index a uint8_t can address.
+#ifdef SL_ZIGBEE_ROUTE_TABLE_SIZE
+#define JOURNAL_ROUTE_TABLE_SIZE SL_ZIGBEE_ROUTE_TABLE_SIZE
+#else
+#define JOURNAL_ROUTE_TABLE_SIZE 255
+#endif
+
+_Static_assert(JOURNAL_ROUTE_TABLE_SIZE <= 255, "Route table index is a uint8_t");
+
+typedef struct {
+    uint16_t destination;
+    uint16_t next_hop;
+    uint8_t status;
+    uint8_t cost;
+} RouteSnapshot;
+
+extern sli_zigbee_route_table_entry_t sli_zigbee_route_table[];
+extern uint8_t sli_zigbee_route_table_size;
+
+static RouteSnapshot shadow[JOURNAL_ROUTE_TABLE_SIZE];
+
+static RouteTableChange changes[XNCP_ROUTE_TABLE_JOURNAL_SIZE];
+static uint32_t latest_sequence;
+static uint16_t epoch;
+
+static void snapshot(uint8_t index)
+{
+    const sli_zigbee_route_table_entry_t *entry = &sli_zigbee_route_table[index];
+
+    shadow[index].destination = entry->destination;
+    shadow[index].next_hop = entry->nextHop;
+    shadow[index].status = entry->status;
+    shadow[index].cost = entry->cost;
+}
+
+// Entries covered by the shadow copy, the stack's table should never be larger
+static uint8_t tracked_size(void)
+{
+    return (sli_zigbee_route_table_size < JOURNAL_ROUTE_TABLE_SIZE) ? sli_zigbee_route_table_size
+                                                                    : JOURNAL_ROUTE_TABLE_SIZE;
+}
+
+void route_table_journal_init(void)
+{
+    uint8_t size = tracked_size();
+
+    for (uint8_t i = 0; i < size; i++) {
+        snapshot(i);
+    }
+
+    latest_sequence = 0;
+    epoch = xncp_get_pseudo_random_number();
+}
+
+void route_table_journal_update(void)
+{
+    uint8_t size = tracked_size();
+
+    for (uint8_t i = 0; i < size; i++) {
+        const sli_zigbee_route_table_entry_t *entry = &sli_zigbee_route_table[i];
+        RouteSnapshot *old = &shadow[i];
+
+        if ((entry->destination == old->destination)
+            && (entry->nextHop == old->next_hop)
+            && (entry->status == old->status)
+            && (entry->cost == old->cost)) {
+            continue;
+        }
+
+        latest_sequence++;
+
+        RouteTableChange *change = &changes[latest_sequence % XNCP_ROUTE_TABLE_JOURNAL_SIZE];
+        change->index = i;
+        change->status = entry->status;
+        change->cost = entry->cost;
+        change->destination = entry->destination;
+        change->old_next_hop = old->next_hop;
+        change->new_next_hop = entry->nextHop;
+
+        snapshot(i);
+    }
+}
+
+void route_table_journal_accept(uint8_t index)
+{
+    if (index < tracked_size()) {
+        snapshot(index);
+    }
+}
+
+uint16_t route_table_journal_get_epoch(void)
+{
+    return epoch;
+}
+
+uint32_t route_table_journal_get_latest_sequence(void)
+{
+    return latest_sequence;
+}
+
+const RouteTableChange* route_table_journal_get(uint32_t sequence)
+{
+    if ((sequence == 0)
+        || (sequence > latest_sequence)
+        || ((latest_sequence - sequence) >= XNCP_ROUTE_TABLE_JOURNAL_SIZE)) {
+        return NULL;
+    }
+
+    return &changes[sequence % XNCP_ROUTE_TABLE_JOURNAL_SIZE];
+}
+
+#endif // XNCP_ROUTE_TABLE_JOURNAL_ENABLED
@@ -0,0 +1,340 @@
+/*
+ * send_benchmark.c
+ *
+ * APS send path benchmark (XNCP_FEATURE_SEND_BENCHMARK)
+ *
+ * Offers unicasts to the combined send handler at a fixed rate from the main loop, so
+ * the APS unicast message pool and the packet buffer heap can be sized from measured
+ * data instead of guesses. Every send goes through xncp_handle_send_unicast, exactly
+ * like a host request, and is timed in core clock cycles with the DWT cycle counter.
+ * Queueing failures are counted by cause; completions are matched by message tag.
+ *
+ * Sending from the NCP itself keeps the UART out of the measurement: the host only
+ * starts a run and reads the results once it is over.
+ */
+
+#include "send_benchmark.h"
+#include "xncp_common_commands.h"
+#include "xncp_buffer.h"
+
+#if XNCP_SEND_BENCHMARK_ENABLED
+
+#include "em_device.h"
+#include "buffer_manager/buffer-management.h"
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+// Largest APS payload without APS encryption or fragmentation
+#define SEND_BENCHMARK_MAX_PAYLOAD_LENGTH 82
+
+// flags(1) + destination(2) + aps_frame(11) + message_tag(1)
+#define SEND_REQUEST_HEADER_LENGTH 15
+
+// Bounds the time spent in one main loop pass, the stack has to run in between
+#define MAX_SENDS_PER_PASS 8
+
+typedef enum {
+    SEND_BENCHMARK_IDLE = 0,
+    SEND_BENCHMARK_SENDING = 1,
+    SEND_BENCHMARK_DRAINING = 2,  // Everything was offered, waiting for completions
+    SEND_BENCHMARK_DONE = 3,
+} SendBenchmarkState;
+
+typedef struct {
+    uint32_t elapsed_ms;         // Duration of the sending phase
+    uint16_t offered;
+    uint16_t queued;
+    uint16_t delivered;
+    uint16_t delivery_failed;
+    uint16_t queue_full;         // SL_STATUS_ZIGBEE_MAX_MESSAGE_LIMIT_REACHED
+    uint16_t no_buffers;         // SL_STATUS_ALLOCATION_FAILED
+    uint16_t other_failures;
+    sl_status_t last_other_status;
+    uint32_t latency_min_cycles;
+    uint32_t latency_max_cycles;
+    uint64_t latency_total_cycles;
+    uint16_t max_in_flight;
+    uint16_t heap_start_bytes;
+    uint16_t heap_min_bytes;
+} SendBenchmarkResults;
+
+static SendBenchmarkState state;
+static SendBenchmarkResults results;
+
+static uint16_t messages_per_s;
+static uint16_t message_count;
+static uint32_t start_ms;
+
+// Prebuilt send_unicast request, only the APS sequence changes between sends
+static uint8_t request[SEND_REQUEST_HEADER_LENGTH + SEND_BENCHMARK_MAX_PAYLOAD_LENGTH];
+static uint8_t request_length;
+
+static uint32_t now_ms(void)
+{
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint32_t)ms;
+}
+
+static uint32_t cycle_counter_start(void)
+{
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+#if defined(DCB)
+        DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+#else
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#endif
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    return DWT->CYCCNT;
+}
+
+static uint16_t in_flight(void)
+{
+    return results.queued - results.delivered - results.delivery_failed;
+}
+
+static void sample_heap(void)
+{
+    uint16_t remaining = sl_legacy_buffer_manager_buffer_bytes_remaining();
+
+    if (remaining < results.heap_min_bytes) {
+        results.heap_min_bytes = remaining;
+    }
+}
+
+static void update_state(void)
+{
+    if ((state == SEND_BENCHMARK_DRAINING) && (in_flight() == 0)) {
+        state = SEND_BENCHMARK_DONE;
+    }
+}
+
+static void send_one(void)
+{
+    uint8_t reply[5];
+    uint8_t reply_length = 0;
+    uint8_t status = XNCP_STATUS_OK;
+    uint16_t response_id = XNCP_CMD_UNKNOWN;
+
+    xncp_context_t ctx = {
+        .command_id = XNCP_CMD_SEND_UNICAST_REQ,
+        .payload = request,
+        .payload_length = request_length,
+        .reply = reply,
+        .reply_length = &reply_length,
+        .reply_capacity = sizeof(reply),
+        .status = &status,
+        .response_id = &response_id
+    };
+
+    // The APS sequence field of the request
+    request[13] = (uint8_t)results.offered;
+
+    uint32_t start = cycle_counter_start();
+    xncp_handle_send_unicast(&ctx);
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    results.offered++;
+    results.latency_total_cycles += cycles;
+
+    if (cycles < results.latency_min_cycles) {
+        results.latency_min_cycles = cycles;
+    }
+
+    if (cycles > results.latency_max_cycles) {
+        results.latency_max_cycles = cycles;
+    }
+
+    xncp_reader_t reader;
+    xncp_reader_init(&reader, reply, reply_length);
+    sl_status_t send_status = xncp_read_u32(&reader);
+
+    if ((status != XNCP_STATUS_OK) || !xncp_reader_ok(&reader)) {
+        send_status = SL_STATUS_FAIL;
+    }
+
+    if (send_status == SL_STATUS_OK) {
+        results.queued++;
+
+        if (in_flight() > results.max_in_flight) {
+            results.max_in_flight = in_flight();
+        }
+    } else if (send_status == SL_STATUS_ZIGBEE_MAX_MESSAGE_LIMIT_REACHED) {
+        results.queue_full++;
+    } else if (send_status == SL_STATUS_ALLOCATION_FAILED) {
+        results.no_buffers++;
+    } else {
+        results.other_failures++;
+        results.last_other_status = send_status;
+    }
+
+    sample_heap();
+}
+
+void send_benchmark_process_action(void)
+{
+    if (state != SEND_BENCHMARK_SENDING) {
+        return;
+    }
+
+    uint32_t elapsed_ms = now_ms() - start_ms;
+
+    // Messages due by now, the first one is sent right away
+    uint32_t due = (uint32_t)(((uint64_t)elapsed_ms * messages_per_s) / 1000) + 1;
+
+    if (due > message_count) {
+        due = message_count;
+    }
+
+    for (uint8_t i = 0; (i < MAX_SENDS_PER_PASS) && (results.offered < due); i++) {
+        send_one();
+    }
+
+    results.elapsed_ms = elapsed_ms;
+
+    if (results.offered == message_count) {
+        state = SEND_BENCHMARK_DRAINING;
+        update_state();
+    }
+}
+
+void send_benchmark_message_sent(sl_status_t status, uint16_t message_tag)
+{
+    if ((message_tag != SEND_BENCHMARK_MESSAGE_TAG) || (in_flight() == 0)) {
+        return;
+    }
+
+    if (status == SL_STATUS_OK) {
+        results.delivered++;
+    } else {
+        results.delivery_failed++;
+    }
+
+    sample_heap();
+    update_state();
+}
+
+// Request:  destination(2) profile_id(2) cluster_id(2) endpoint(1) aps_options(2)
+//           messages_per_s(2) count(2) payload_length(1)
+//
+// Starts a run that offers `count` unicasts of `payload_length` zero bytes at
+// `messages_per_s`, replacing any run in progress. A count of 0 stops the benchmark.
+// Messages are sent with SEND_BENCHMARK_MESSAGE_TAG, the host should not use that tag
+// for its own messages while a run is in progress.
+bool xncp_handle_start_send_benchmark(xncp_context_t *ctx)
+{
+    xncp_reader_t reader = xncp_payload_reader(ctx);
+
+    uint16_t destination = xncp_read_u16(&reader);
+    uint16_t profile_id = xncp_read_u16(&reader);
+    uint16_t cluster_id = xncp_read_u16(&reader);
+    uint8_t endpoint = xncp_read_u8(&reader);
+    uint16_t aps_options = xncp_read_u16(&reader);
+    uint16_t rate = xncp_read_u16(&reader);
+    uint16_t count = xncp_read_u16(&reader);
+    uint8_t payload_length = xncp_read_u8(&reader);
+
+    if (!xncp_reader_done(&reader)
+        || (payload_length > SEND_BENCHMARK_MAX_PAYLOAD_LENGTH)
+        || ((count != 0) && (rate == 0))) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    if (count == 0) {
+        state = SEND_BENCHMARK_IDLE;
+        *ctx->status = XNCP_STATUS_OK;
+        return true;
+    }
+
+    // Same layout as a send_unicast request without optional fields
+    uint8_t *p = request;
+    *p++ = 0;  // flags
+    *p++ = (uint8_t)((destination >> 0) & 0xFF);
+    *p++ = (uint8_t)((destination >> 8) & 0xFF);
+    *p++ = (uint8_t)((profile_id >> 0) & 0xFF);
+    *p++ = (uint8_t)((profile_id >> 8) & 0xFF);
+    *p++ = (uint8_t)((cluster_id >> 0) & 0xFF);
+    *p++ = (uint8_t)((cluster_id >> 8) & 0xFF);
+    *p++ = endpoint;  // Source endpoint
+    *p++ = endpoint;  // Destination endpoint
+    *p++ = (uint8_t)((aps_options >> 0) & 0xFF);
+    *p++ = (uint8_t)((aps_options >> 8) & 0xFF);
+    *p++ = 0;  // Group ID
+    *p++ = 0;
+    *p++ = 0;  // APS sequence, set per send
+    *p++ = SEND_BENCHMARK_MESSAGE_TAG;
+    memset(p, 0, payload_length);
+    request_length = SEND_REQUEST_HEADER_LENGTH + payload_length;
+
+    memset(&results, 0, sizeof(results));
+    results.latency_min_cycles = UINT32_MAX;
+    results.heap_start_bytes = sl_legacy_buffer_manager_buffer_bytes_remaining();
+    results.heap_min_bytes = results.heap_start_bytes;
+
+    messages_per_s = rate;
+    message_count = count;
+    start_ms = now_ms();
+    state = SEND_BENCHMARK_SENDING;
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+// Response: state(1) core_clock_hz(4) elapsed_ms(4) offered(2) queued(2) delivered(2)
+//           delivery_failed(2) queue_full(2) no_buffers(2) other_failures(2)
+//           last_other_status(4) latency_min_cycles(4) latency_avg_cycles(4)
+//           latency_max_cycles(4) max_in_flight(2) heap_start_bytes(2) heap_min_bytes(2)
+//
+// `state` is 0 before the first run, 1 while sending, 2 while waiting for the last
+// completions and 3 once the run is over. `elapsed_ms` covers the sending phase, so
+// queued / elapsed_ms is the sustained enqueue rate.
+bool xncp_handle_get_send_benchmark_results(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 0) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    uint32_t latency_avg = (results.offered == 0)
+                           ? 0
+                           : (uint32_t)(results.latency_total_cycles / results.offered);
+
+    xncp_reply_put_u8(ctx, state);
+    xncp_reply_put_u32(ctx, SystemCoreClockGet());
+    xncp_reply_put_u32(ctx, results.elapsed_ms);
+    xncp_reply_put_u16(ctx, results.offered);
+    xncp_reply_put_u16(ctx, results.queued);
+    xncp_reply_put_u16(ctx, results.delivered);
+    xncp_reply_put_u16(ctx, results.delivery_failed);
+    xncp_reply_put_u16(ctx, results.queue_full);
+    xncp_reply_put_u16(ctx, results.no_buffers);
+    xncp_reply_put_u16(ctx, results.other_failures);
+    xncp_reply_put_u32(ctx, results.last_other_status);
+    xncp_reply_put_u32(ctx, (results.offered == 0) ? 0 : results.latency_min_cycles);
+    xncp_reply_put_u32(ctx, latency_avg);
+    xncp_reply_put_u32(ctx, results.latency_max_cycles);
+    xncp_reply_put_u16(ctx, results.max_in_flight);
+    xncp_reply_put_u16(ctx, results.heap_start_bytes);
+    xncp_reply_put_u16(ctx, results.heap_min_bytes);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+#else
+
+void send_benchmark_process_action(void)
+{
+}
+
+void send_benchmark_message_sent(sl_status_t status, uint16_t message_tag)
+{
+    (void)status;
+    (void)message_tag;
+}
+
+#endif // XNCP_SEND_BENCHMARK_ENABLED
@@ -2,81 +2,78 @@
  * tx_power.c
  *
  * Country-specific TX Power Settings
+ *
+ * The table itself is generated from the `xncp_tx_power` template contributions in
+ * xncp_common_commands.slcc, sorted by country code.
  */
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "tx_power.h"
 
-static const CountryTxPower COUNTRY_TX_POWERS[] = {
-  // EU Member States
-  {{'A', 'T'}, 10, 10},  // Austria
-  {{'B', 'E'}, 10, 10},  // Belgium
-  {{'B', 'G'}, 10, 10},  // Bulgaria
-  {{'H', 'R'}, 10, 10},  // Croatia
-  {{'C', 'Y'}, 10, 10},  // Cyprus
-  {{'C', 'Z'}, 10, 10},  // Czech Republic
-  {{'D', 'K'}, 10, 10},  // Denmark
-  {{'E', 'E'}, 10, 10},  // Estonia
-  {{'F', 'I'}, 10, 10},  // Finland
-  {{'F', 'R'}, 10, 10},  // France
-  {{'D', 'E'}, 10, 10},  // Germany
-  {{'G', 'R'}, 10, 10},  // Greece
-  {{'H', 'U'}, 10, 10},  // Hungary
-  {{'I', 'E'}, 10, 10},  // Ireland
-  {{'I', 'T'}, 10, 10},  // Italy
-  {{'L', 'V'}, 10, 10},  // Latvia
-  {{'L', 'T'}, 10, 10},  // Lithuania
-  {{'L', 'U'}, 10, 10},  // Luxembourg
-  {{'M', 'T'}, 10, 10},  // Malta
-  {{'N', 'L'}, 10, 10},  // Netherlands
-  {{'P', 'L'}, 10, 10},  // Poland
-  {{'P', 'T'}, 10, 10},  // Portugal
-  {{'R', 'O'}, 10, 10},  // Romania
-  {{'S', 'K'}, 10, 10},  // Slovakia
-  {{'S', 'I'}, 10, 10},  // Slovenia
-  {{'E', 'S'}, 10, 10},  // Spain
-  {{'S', 'E'}, 10, 10},  // Sweden
-  // EEA Members
-  {{'I', 'S'}, 10, 10},  // Iceland
-  {{'L', 'I'}, 10, 10},  // Liechtenstein
-  {{'N', 'O'}, 10, 10},  // Norway
-  // Standards harmonized with RED or ETSI
-  {{'C', 'H'}, 10, 10},  // Switzerland
-  {{'G', 'B'}, 10, 10},  // United Kingdom
-  {{'T', 'R'}, 10, 10},  // Turkey
-  {{'A', 'L'}, 10, 10},  // Albania
-  {{'B', 'A'}, 10, 10},  // Bosnia and Herzegovina
-  {{'G', 'E'}, 10, 10},  // Georgia
-  {{'M', 'D'}, 10, 10},  // Moldova
-  {{'M', 'E'}, 10, 10},  // Montenegro
-  {{'M', 'K'}, 10, 10},  // North Macedonia
-  {{'R', 'S'}, 10, 10},  // Serbia
-  {{'U', 'A'}, 10, 10},  // Ukraine
-  // Other CEPT nations
-  {{'A', 'D'}, 10, 10},  // Andorra
-  {{'A', 'Z'}, 10, 10},  // Azerbaijan
-  {{'M', 'C'}, 10, 10},  // Monaco
-  {{'S', 'M'}, 10, 10},  // San Marino
-  {{'V', 'A'}, 10, 10},  // Vatican City
-  // Disable the maximum, for testing
-  {{'?', '?'}, 8, 127},
-};
-
-void get_tx_power_for_country(const char c1, const char c2, CountryTxPower *output) {
+static const TxPowerTableEntry* find_country(uint16_t code)
+{
+  uint8_t low = 0;
+  uint8_t high = tx_power_table_size;
+
+  while (low < high) {
+    uint8_t mid = low + (high - low) / 2;
+
+    if (tx_power_table[mid].code == code) {
+      return &tx_power_table[mid];
+    } else if (tx_power_table[mid].code < code) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return NULL;
+}
+
+// Per-channel limits only ever lower the country maximum
+static void apply_channel_limits(uint16_t code, int8_t channel_max_power_dbm[TX_POWER_CHANNEL_COUNT])
+{
+  const TxPowerChannelLimit *limit = tx_power_channel_limits;
+
+  while (limit->code < code) {
+    limit++;
+  }
+
+  for (; limit->code == code; limit++) {
+    uint8_t index = limit->channel - TX_POWER_FIRST_CHANNEL;
+
+    if ((index < TX_POWER_CHANNEL_COUNT) && (limit->max_power_dbm < channel_max_power_dbm[index])) {
+      channel_max_power_dbm[index] = limit->max_power_dbm;
+    }
+  }
+}
+
+bool get_tx_power_for_country(const char c1, const char c2, CountryTxPower *output) {
+  uint16_t code = TX_POWER_COUNTRY_CODE(c1, c2);
+  const TxPowerTableEntry *entry = find_country(code);
+
   output->code[0] = c1;
   output->code[1] = c2;
 
-  for (uint8_t i = 0; i < sizeof(COUNTRY_TX_POWERS) / sizeof(CountryTxPower); i++) {
-    if (COUNTRY_TX_POWERS[i].code[0] == c1 && COUNTRY_TX_POWERS[i].code[1] == c2) {
-      output->recommended_power_dbm = COUNTRY_TX_POWERS[i].recommended_power_dbm;
-      output->max_power_dbm = COUNTRY_TX_POWERS[i].max_power_dbm;
-      return;
-    }
+  if (entry != NULL) {
+    output->recommended_power_dbm = entry->recommended_power_dbm;
+    output->max_power_dbm = entry->max_power_dbm;
+  } else {
+    // Not found, return default
+    output->recommended_power_dbm = XNCP_DEFAULT_RECOMMENDED_TX_POWER_DBM;
+    output->max_power_dbm = XNCP_DEFAULT_MAX_TX_POWER_DBM;
+  }
+
+  for (uint8_t i = 0; i < TX_POWER_CHANNEL_COUNT; i++) {
+    output->channel_max_power_dbm[i] = output->max_power_dbm;
+  }
+
+  if (entry != NULL) {
+    apply_channel_limits(code, output->channel_max_power_dbm);
   }
 
-  // Not found, return default
-  output->recommended_power_dbm = XNCP_DEFAULT_RECOMMENDED_TX_POWER_DBM;
-  output->max_power_dbm = XNCP_DEFAULT_MAX_TX_POWER_DBM;
+  return (entry != NULL);
 }
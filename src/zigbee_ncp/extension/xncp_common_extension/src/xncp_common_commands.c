@@ -6,12 +6,23 @@
 
 #include "xncp_common_commands.h"
 #include "xncp_types.h"
+#include "xncp_buffer.h"
 #include "xncp_config.h"
 #include "tx_power.h"
+#include "manual_source_route.h"
+#include "address_cache.h"
+#include "route_table_journal.h"
+#include "multicast_filter.h"
+#include "incoming_filter.h"
+#include "neighbor_stats.h"
+#include "memory_stats.h"
+#include "send_benchmark.h"
+#include "xncp_notify.h"
 #include "ezsp-enum.h"
 #include "em_usart.h"
 #include "random.h"
 #include "stack/include/stack-info.h"
+#include "sl_sleeptimer.h"
 
 #if defined(SL_CATALOG_IOSTREAM_EUSART_PRESENT)
 #include "sl_iostream_eusart.h"
@@ -39,90 +50,415 @@ typedef enum {
   ROUTE_VALIDATING = 4
 } RouteStatus;
 
-typedef struct ManualSourceRoute {
-  bool active;
-  uint16_t destination;
-  uint8_t num_relays;
-  uint16_t relays[XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT];
-} ManualSourceRoute;
-
-static ManualSourceRoute manual_source_routes[XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE];
-
 // External references to EmberZNet internal tables
 extern sli_zigbee_route_table_entry_t sli_zigbee_route_table[];
 extern uint8_t sli_zigbee_route_table_size;
-extern uint8_t sli_zigbee_address_table_size;
 
 //------------------------------------------------------------------------------
-// Forward declarations
+// Initialization
 //------------------------------------------------------------------------------
 
-static bool handle_set_source_route(xncp_context_t *ctx);
-static bool handle_get_mfg_token_override(xncp_context_t *ctx);
-static bool handle_get_build_string(xncp_context_t *ctx);
-static bool handle_get_flow_control_type(xncp_context_t *ctx);
-static bool handle_get_chip_info(xncp_context_t *ctx);
-static bool handle_set_route_table_entry(xncp_context_t *ctx);
-static bool handle_get_route_table_entry(xncp_context_t *ctx);
-static bool handle_get_tx_power_info(xncp_context_t *ctx);
-static bool handle_send_unicast(xncp_context_t *ctx);
+// SDK init callback
+void xncp_common_init(uint8_t init_level)
+{
+    (void)init_level;
+    memory_stats_init();
+    manual_source_route_init();
+    address_cache_init();
+    route_table_journal_init();
+    multicast_filter_init();
+    incoming_filter_init();
+    neighbor_stats_init();
+}
 
 //------------------------------------------------------------------------------
-// Command table
+// Multicast override (XNCP_FEATURE_MEMBER_OF_ALL_GROUPS)
 //------------------------------------------------------------------------------
 
-const xncp_command_def_t xncp_common_commands[] = {
-    {0x0001, handle_set_source_route},
-    {0x0002, handle_get_mfg_token_override},
-    {0x0003, handle_get_build_string},
-    {0x0004, handle_get_flow_control_type},
-    {0x0005, handle_get_chip_info},
-    {0x0006, handle_set_route_table_entry},
-    {0x0007, handle_get_route_table_entry},
-    {0x0008, handle_get_tx_power_info},
-    {0x0009, handle_send_unicast},
-    {0, NULL}  // sentinel
-};
+bool __real_sli_zigbee_am_multicast_member(xncp_multicast_id_t multicastId);
+
+bool __wrap_sli_zigbee_am_multicast_member(xncp_multicast_id_t multicastId)
+{
+    // Ignore all binding and multicast table logic, we want all group packets unless the
+    // host narrowed them down (XNCP_FEATURE_MULTICAST_FILTER)
+    if (!multicast_filter_is_enabled()) {
+        return true;
+    }
+
+    // Groups in the stack's own multicast table are always delivered
+    bool accepted = multicast_filter_contains(multicastId)
+                    || __real_sli_zigbee_am_multicast_member(multicastId);
+
+    multicast_filter_record(accepted);
+    return accepted;
+}
 
 //------------------------------------------------------------------------------
-// Initialization
+// Multicast filter (XNCP_FEATURE_MULTICAST_FILTER)
 //------------------------------------------------------------------------------
 
-// SDK init callback
-void xncp_common_init(uint8_t init_level)
+#define XNCP_MULTICAST_FILTER_FLAG_ENABLE (1 << 0)
+#define XNCP_MULTICAST_FILTER_FLAG_APPEND (1 << 1)
+
+#define XNCP_MULTICAST_FILTER_STATS_FLAG_RESET (1 << 0)
+
+static void append_multicast_filter_info(xncp_context_t *ctx)
 {
-    (void)init_level;
-    for (uint8_t i = 0; i < XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE; i++) {
-        manual_source_routes[i].active = false;
+    xncp_reply_put_u16(ctx, multicast_filter_get_count());
+    xncp_reply_put_u16(ctx, XNCP_MULTICAST_FILTER_SIZE);
+}
+
+// Request:  flags(1) [group_id(2)]*
+// Response: group_count(2) capacity(2)
+//
+// Replaces the accepted groups, or adds to them with XNCP_MULTICAST_FILTER_FLAG_APPEND,
+// and enables the filter if XNCP_MULTICAST_FILTER_FLAG_ENABLE is set. Without it every
+// group is accepted again, which is the default. Lists that do not fit into a single
+// frame are uploaded with several appending requests. A request that may not fit into
+// the filter is rejected as a whole, counting duplicates.
+bool xncp_handle_set_multicast_filter(xncp_context_t *ctx)
+{
+    if ((ctx->payload_length < 1) || (((ctx->payload_length - 1) % 2) != 0)) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
     }
+
+    uint8_t flags = ctx->payload[0];
+    uint8_t num_groups = (ctx->payload_length - 1) / 2;
+    uint16_t existing = (flags & XNCP_MULTICAST_FILTER_FLAG_APPEND) ? multicast_filter_get_count() : 0;
+
+    if ((existing + num_groups) > XNCP_MULTICAST_FILTER_SIZE) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    for (uint8_t i = 0; i < num_groups; i++) {
+        if (BUILD_UINT16(ctx->payload[1 + 2 * i], ctx->payload[2 + 2 * i]) == 0xFFFF) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+    }
+
+    if (!(flags & XNCP_MULTICAST_FILTER_FLAG_APPEND)) {
+        multicast_filter_clear();
+    }
+
+    for (uint8_t i = 0; i < num_groups; i++) {
+        multicast_filter_add(BUILD_UINT16(ctx->payload[1 + 2 * i], ctx->payload[2 + 2 * i]));
+    }
+
+    multicast_filter_set_enabled((flags & XNCP_MULTICAST_FILTER_FLAG_ENABLE) != 0);
+
+    append_multicast_filter_info(ctx);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+// Request:  flags(1)
+// Response: enabled(1) group_count(2) capacity(2) accepted(4) rejected(4)
+//
+// `accepted` and `rejected` count group frames checked while the filter was enabled.
+bool xncp_handle_get_multicast_filter_stats(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 1) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    const MulticastFilterStats *stats = multicast_filter_get_stats();
+
+    xncp_reply_put_u8(ctx, multicast_filter_is_enabled());
+    append_multicast_filter_info(ctx);
+    xncp_reply_put_u32(ctx, stats->accepted);
+    xncp_reply_put_u32(ctx, stats->rejected);
+
+    if (ctx->payload[0] & XNCP_MULTICAST_FILTER_STATS_FLAG_RESET) {
+        multicast_filter_reset_stats();
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
 }
 
 //------------------------------------------------------------------------------
-// Multicast override (XNCP_FEATURE_MEMBER_OF_ALL_GROUPS)
+// Incoming message filter (XNCP_FEATURE_INCOMING_FILTER)
 //------------------------------------------------------------------------------
 
-bool __wrap_sli_zigbee_am_multicast_member(xncp_multicast_id_t multicastId)
+void __real_sli_zigbee_stack_incoming_message_handler(sl_zigbee_incoming_message_type_t type,
+                                                       sl_zigbee_aps_frame_t *apsFrame,
+                                                       sl_zigbee_rx_packet_info_t *packetInfo,
+                                                       uint8_t messageLength,
+                                                       uint8_t *message);
+
+// Dropping frames here keeps them from being dispatched to the NCP, which would
+// otherwise serialize every one of them to the host. With the incoming filter, neighbor
+// and memory statistics all disabled, this is a plain forward.
+void __wrap_sli_zigbee_stack_incoming_message_handler(sl_zigbee_incoming_message_type_t type,
+                                                       sl_zigbee_aps_frame_t *apsFrame,
+                                                       sl_zigbee_rx_packet_info_t *packetInfo,
+                                                       uint8_t messageLength,
+                                                       uint8_t *message)
+{
+    // Link quality is tracked for every frame, including the ones the host does not want
+    neighbor_stats_record_rx(packetInfo->sender_short_id,
+                             packetInfo->last_hop_rssi,
+                             packetInfo->last_hop_lqi);
+
+    if ((type == SL_ZIGBEE_INCOMING_BROADCAST) || (type == SL_ZIGBEE_INCOMING_MULTICAST)) {
+        memory_stats_broadcast_seen();
+    }
+
+    if (!incoming_filter_accepts(packetInfo->sender_short_id, apsFrame, message, messageLength)) {
+        return;
+    }
+
+    __real_sli_zigbee_stack_incoming_message_handler(type, apsFrame, packetInfo,
+                                                     messageLength, message);
+}
+
+#if XNCP_INCOMING_FILTER_ENABLED
+
+#define XNCP_INCOMING_FILTER_STATS_FLAG_RESET (1 << 0)
+
+// Request:  dedup_window_ms(2) [profile_id(2) cluster_id(2)]*
+//
+// Replaces the drop rules. A cluster ID of 0xFFFF drops the whole profile. An attribute
+// report identical to the last one forwarded for the same sender, endpoint, cluster and
+// attribute less than `dedup_window_ms` ago is dropped too, 0 forwards all of them.
+bool xncp_handle_set_incoming_filter(xncp_context_t *ctx)
 {
-    (void)multicastId;
-    // Ignore all binding and multicast table logic, we want all group packets
+    if ((ctx->payload_length < 2)
+        || (((ctx->payload_length - 2) % 4) != 0)
+        || (((ctx->payload_length - 2) / 4) > XNCP_INCOMING_FILTER_MAX_RULES)) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    xncp_reader_t reader = xncp_payload_reader(ctx);
+
+    incoming_filter_set_dedup_window(xncp_read_u16(&reader));
+    incoming_filter_clear_rules();
+
+    while (xncp_reader_has_more(&reader)) {
+        uint16_t profile_id = xncp_read_u16(&reader);
+        uint16_t cluster_id = xncp_read_u16(&reader);
+
+        incoming_filter_add_rule(profile_id, cluster_id);
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
+// Request:  flags(1)
+// Response: passed(4) dropped_by_rule(4) dropped_duplicates(4)
+bool xncp_handle_get_incoming_filter_stats(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 1) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    const IncomingFilterStats *stats = incoming_filter_get_stats();
+    xncp_reply_put_u32(ctx, stats->passed);
+    xncp_reply_put_u32(ctx, stats->dropped_by_rule);
+    xncp_reply_put_u32(ctx, stats->dropped_duplicates);
+
+    if (ctx->payload[0] & XNCP_INCOMING_FILTER_STATS_FLAG_RESET) {
+        incoming_filter_reset_stats();
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+#endif // XNCP_INCOMING_FILTER_ENABLED
+
 //------------------------------------------------------------------------------
-// Source route management (XNCP_FEATURE_MANUAL_SOURCE_ROUTE)
+// Neighbor statistics (XNCP_FEATURE_NEIGHBOR_STATS)
 //------------------------------------------------------------------------------
 
-static ManualSourceRoute* get_manual_source_route(xncp_node_id_t destination)
+// Callback registered via template_contribution
+void xncp_common_counter_cb(sl_zigbee_counter_type_t type, sl_zigbee_counter_info_t info)
 {
-    for (uint8_t i = 0; i < XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE; i++) {
-        if (manual_source_routes[i].active &&
-            manual_source_routes[i].destination == destination) {
-            return &manual_source_routes[i];
+    if (type == SL_ZIGBEE_COUNTER_ALLOCATE_PACKET_BUFFER_FAILURE) {
+        memory_stats_record_full(MEMORY_POOL_PACKET_BUFFER_HEAP);
+        return;
+    } else if (type == SL_ZIGBEE_COUNTER_BROADCAST_TABLE_FULL) {
+        memory_stats_record_full(MEMORY_POOL_BROADCAST_TABLE);
+        return;
+    }
+
+    // MAC unicast counters carry the neighbor the frame was sent to
+    const sl_802154_short_addr_t *destination = (const sl_802154_short_addr_t *)info.other_fields;
+
+    if (destination == NULL) {
+        return;
+    }
+
+    switch (type) {
+        case SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_SUCCESS:
+            neighbor_stats_record_tx_success(*destination);
+            break;
+        case SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_RETRY:
+            neighbor_stats_record_mac_retry(*destination);
+            break;
+        case SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_FAILED:
+            neighbor_stats_record_tx_failure(*destination);
+            break;
+        default:
+            break;
+    }
+}
+
+#if XNCP_NEIGHBOR_STATS_ENABLED
+
+// node_id(2) age_s(2) rssi_average(1) rssi_min(1) rssi_max(1) lqi_average(1) lqi_min(1)
+// lqi_max(1) rx_packets(2) tx_packets(2) mac_retries(2) tx_failures(2)
+#define NEIGHBOR_STATS_ENTRY_SIZE 18
+
+#define XNCP_NEIGHBOR_STATS_FLAG_RESET (1 << 0)
+
+static void append_neighbor_stats(xncp_context_t *ctx, const NeighborStats *entry, uint32_t now)
+{
+    uint32_t age_s = (now - entry->last_seen_ms) / 1000;
+
+    // Averages are rounded to the nearest unit
+    int16_t rssi_average = entry->rssi_average;
+    rssi_average += (rssi_average < 0) ? -(NEIGHBOR_STATS_AVERAGE_SCALE / 2)
+                                       : (NEIGHBOR_STATS_AVERAGE_SCALE / 2);
+
+    xncp_reply_put_u16(ctx, entry->node_id);
+    xncp_reply_put_u16(ctx, (age_s > UINT16_MAX) ? UINT16_MAX : (uint16_t)age_s);
+    xncp_reply_put_u8(ctx, (uint8_t)(int8_t)(rssi_average / NEIGHBOR_STATS_AVERAGE_SCALE));
+    xncp_reply_put_u8(ctx, (uint8_t)entry->rssi_min);
+    xncp_reply_put_u8(ctx, (uint8_t)entry->rssi_max);
+    xncp_reply_put_u8(ctx, (uint8_t)((entry->lqi_average + NEIGHBOR_STATS_AVERAGE_SCALE / 2)
+                                     / NEIGHBOR_STATS_AVERAGE_SCALE));
+    xncp_reply_put_u8(ctx, entry->lqi_min);
+    xncp_reply_put_u8(ctx, entry->lqi_max);
+    xncp_reply_put_u16(ctx, entry->rx_packets);
+    xncp_reply_put_u16(ctx, entry->tx_packets);
+    xncp_reply_put_u16(ctx, entry->mac_retries);
+    xncp_reply_put_u16(ctx, entry->tx_failures);
+}
+
+// Request:  start_index(1) flags(1)
+// Response: table_size(1) next_index(1) count(1) [node_id(2) age_s(2) rssi_average(1)
+//           rssi_min(1) rssi_max(1) lqi_average(1) lqi_min(1) lqi_max(1) rx_packets(2)
+//           tx_packets(2) mac_retries(2) tx_failures(2)]*
+//
+// Fills the reply with as many neighbors as fit, starting at `start_index`. The host
+// pages through the table by passing back `next_index` until it equals `table_size`.
+// RSSI is in dBm; min/max and counters only cover frames since the last reset, a
+// neighbor without received frames reports rssi_min > rssi_max. With
+// XNCP_NEIGHBOR_STATS_FLAG_RESET, the returned neighbors are reset after being read.
+bool xncp_handle_get_neighbor_stats(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 2) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    uint8_t index = ctx->payload[0];
+    uint8_t flags = ctx->payload[1];
+
+    if (index > XNCP_NEIGHBOR_STATS_SIZE) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    xncp_reply_put_u8(ctx, XNCP_NEIGHBOR_STATS_SIZE);
+
+    uint8_t *header = xncp_reply_reserve(ctx, 2);
+    if (header == NULL) {
+        return true;
+    }
+
+    uint8_t *next_index = &header[0];
+    uint8_t *count = &header[1];
+    *count = 0;
+
+    uint64_t now_ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &now_ms);
+
+    for (; index < XNCP_NEIGHBOR_STATS_SIZE; index++) {
+        const NeighborStats *entry = neighbor_stats_get(index);
+
+        if (entry == NULL) {
+            continue;
+        }
+
+        if (xncp_reply_remaining(ctx) < NEIGHBOR_STATS_ENTRY_SIZE) {
+            break;
+        }
+
+        append_neighbor_stats(ctx, entry, (uint32_t)now_ms);
+        (*count)++;
+
+        if (flags & XNCP_NEIGHBOR_STATS_FLAG_RESET) {
+            neighbor_stats_reset(index);
         }
     }
-    return NULL;
+
+    *next_index = index;
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
 }
 
+#endif // XNCP_NEIGHBOR_STATS_ENABLED
+
+//------------------------------------------------------------------------------
+// Memory statistics (XNCP_FEATURE_MEMORY_STATS)
+//------------------------------------------------------------------------------
+
+#if XNCP_MEMORY_STATS_ENABLED
+
+#define XNCP_MEMORY_STATS_FLAG_RESET (1 << 0)
+
+// Request:  flags(1)
+// Response: pool_count(1) [capacity(2) current(2) high_water(2) full_count(2)]*
+//
+// One entry per MemoryPool, in order. The heap is in bytes, the other pools in table
+// entries. A capacity of 0 means the pool has no fixed size. With
+// XNCP_MEMORY_STATS_FLAG_RESET, high-water marks drop to the current usage and full
+// counts are cleared after being read.
+bool xncp_handle_get_memory_stats(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 1) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    memory_stats_sample_stack();
+
+    xncp_reply_put_u8(ctx, MEMORY_POOL_COUNT);
+
+    for (uint8_t i = 0; i < MEMORY_POOL_COUNT; i++) {
+        const MemoryPoolStats *pool = memory_stats_get((MemoryPool)i);
+
+        xncp_reply_put_u16(ctx, pool->capacity);
+        xncp_reply_put_u16(ctx, pool->current);
+        xncp_reply_put_u16(ctx, pool->high_water);
+        xncp_reply_put_u16(ctx, pool->full_count);
+    }
+
+    if (ctx->payload[0] & XNCP_MEMORY_STATS_FLAG_RESET) {
+        memory_stats_reset();
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+#endif // XNCP_MEMORY_STATS_ENABLED
+
+//------------------------------------------------------------------------------
+// Source route management (XNCP_FEATURE_MANUAL_SOURCE_ROUTE)
+//------------------------------------------------------------------------------
+
 static sli_zigbee_route_table_entry_t* find_free_routing_table_entry(xncp_node_id_t destination)
 {
     uint8_t index = 0xFF;
@@ -146,13 +482,29 @@ static sli_zigbee_route_table_entry_t* find_free_routing_table_entry(xncp_node_i
     return &sli_zigbee_route_table[index];
 }
 
+// Event: destination(2) relay_count(1)
+static void notify_source_route_used(const ManualSourceRoute *route)
+{
+    if (!xncp_notify_is_subscribed(XNCP_EVENT_SOURCE_ROUTE_USED)) {
+        return;
+    }
+
+    uint8_t event[3] = {
+        (uint8_t)((route->destination >> 0) & 0xFF),
+        (uint8_t)((route->destination >> 8) & 0xFF),
+        route->num_relays
+    };
+
+    xncp_notify(XNCP_EVENT_SOURCE_ROUTE_USED, XNCP_NOTIFY_PRIORITY_LOW, event, sizeof(event));
+}
+
 // Callback registered via template_contribution
 void nc_zigbee_override_append_source_route(uint16_t destination,
                                              void *header,
                                              bool *consumed)
 {
     xncp_message_buffer_t *msg_header = (xncp_message_buffer_t *)header;
-    ManualSourceRoute *route = get_manual_source_route(destination);
+    ManualSourceRoute *route = manual_source_route_get(destination);
 
     if (route == NULL) {
         *consumed = false;
@@ -160,6 +512,7 @@ void nc_zigbee_override_append_source_route(uint16_t destination,
     }
 
     *consumed = true;
+    notify_source_route_used(route);
 
     // Empty source routes are invalid according to the spec
     if (route->num_relays == 0) {
@@ -170,57 +523,67 @@ void nc_zigbee_override_append_source_route(uint16_t destination,
         route_table_entry->status = ROUTE_ACTIVE;
         route_table_entry->cost = 0;
         route_table_entry->networkIndex = 0;
+        manual_source_route_use(route);
         return;
     }
 
-    uint8_t relay_index = route->num_relays - 1;
-
-    route->active = false;  // Disable the route after a single use
+    uint16_t relays[XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT];
+    uint8_t num_relays = manual_source_route_get_relays(route, relays);
+    uint8_t relay_index = num_relays - 1;
 
-    xncp_append_to_linked_buffers(*msg_header, &route->num_relays, 1);
+    xncp_append_to_linked_buffers(*msg_header, &num_relays, 1);
     xncp_append_to_linked_buffers(*msg_header, &relay_index, 1);
+    xncp_append_to_linked_buffers(*msg_header, (uint8_t*)relays, num_relays * 2);
 
-    for (uint8_t i = 0; i < route->num_relays; i++) {
-        xncp_append_to_linked_buffers(*msg_header, (uint8_t*)&route->relays[route->num_relays - i - 1], 2);
-    }
+    manual_source_route_use(route);
 }
 
-static void install_manual_source_route(uint16_t node_id,
-                                        const uint8_t *relay_bytes,
-                                        uint8_t num_relays)
+// Legacy source routes are single use, except empty ones which only pin a route table
+// entry and were never consumed
+static uint8_t legacy_source_route_max_uses(uint8_t num_relays)
 {
-    uint8_t insertion_index = xncp_get_pseudo_random_number() % XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE;
-
-    for (uint8_t i = 0; i < XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE; i++) {
-        ManualSourceRoute *route = &manual_source_routes[i];
+    return (num_relays == 0) ? 0 : 1;
+}
 
-        if (route->active == false) {
-            insertion_index = i;
-        } else if (route->destination == node_id) {
-            insertion_index = i;
-            break;
-        }
+bool xncp_handle_set_source_route(xncp_context_t *ctx)
+{
+    if ((ctx->payload_length < 2) || (ctx->payload_length % 2 != 0)) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
     }
 
-    ManualSourceRoute *route = &manual_source_routes[insertion_index];
+    uint8_t num_relays = (ctx->payload_length - 2) / 2;
 
-    for (uint8_t i = 0; i < num_relays; i++) {
-        route->relays[i] = BUILD_UINT16(relay_bytes[2 * i + 0], relay_bytes[2 * i + 1]);
+    if (num_relays > XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
     }
 
-    route->destination = node_id;
-    route->num_relays = num_relays;
-    route->active = true;
+    uint16_t node_id = BUILD_UINT16(ctx->payload[0], ctx->payload[1]);
+    manual_source_route_install(node_id, ctx->payload + 2, num_relays,
+                                legacy_source_route_max_uses(num_relays), 0);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
 }
 
-static bool handle_set_source_route(xncp_context_t *ctx)
+//------------------------------------------------------------------------------
+// Persistent source routes (XNCP_FEATURE_PERSISTENT_SOURCE_ROUTE)
+//------------------------------------------------------------------------------
+
+// Request: node_id(2) max_uses(1) ttl_s(2) [relay(2)]*
+//
+// Like `set_source_route`, but the route is reused for up to `max_uses` messages or
+// `ttl_s` seconds (0 disables either limit), so repeated traffic to the same device
+// does not need to carry the route every time.
+bool xncp_handle_set_persistent_source_route(xncp_context_t *ctx)
 {
-    if ((ctx->payload_length < 2) || (ctx->payload_length % 2 != 0)) {
+    if ((ctx->payload_length < 5) || ((ctx->payload_length - 5) % 2 != 0)) {
         *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
         return true;
     }
 
-    uint8_t num_relays = (ctx->payload_length - 2) / 2;
+    uint8_t num_relays = (ctx->payload_length - 5) / 2;
 
     if (num_relays > XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT) {
         *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
@@ -228,41 +591,176 @@ static bool handle_set_source_route(xncp_context_t *ctx)
     }
 
     uint16_t node_id = BUILD_UINT16(ctx->payload[0], ctx->payload[1]);
-    install_manual_source_route(node_id, ctx->payload + 2, num_relays);
+    uint8_t max_uses = ctx->payload[2];
+    uint16_t ttl_s = BUILD_UINT16(ctx->payload[3], ctx->payload[4]);
+
+    manual_source_route_install(node_id, ctx->payload + 5, num_relays, max_uses, ttl_s);
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
+// Request:  node_id(2)
+// Response: hits(2) failures(2) remaining_uses(1) remaining_ttl_s(2)
+//
+// The hit and failure counters saturate at 255.
+bool xncp_handle_get_source_route_stats(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 2) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    ManualSourceRoute *route = manual_source_route_get(BUILD_UINT16(ctx->payload[0], ctx->payload[1]));
+
+    if (route == NULL) {
+        *ctx->status = XNCP_STATUS_NOT_FOUND;
+        return true;
+    }
+
+    uint16_t ttl_s = manual_source_route_get_ttl(route);
+
+    xncp_reply_put_u16(ctx, route->hits);
+    xncp_reply_put_u16(ctx, route->failures);
+    xncp_reply_put_u8(ctx, route->remaining_uses);
+    xncp_reply_put_u16(ctx, ttl_s);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+// Request: node_id(2)
+bool xncp_handle_clear_source_route(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 2) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    ManualSourceRoute *route = manual_source_route_get(BUILD_UINT16(ctx->payload[0], ctx->payload[1]));
+
+    if (route == NULL) {
+        *ctx->status = XNCP_STATUS_NOT_FOUND;
+        return true;
+    }
+
+    manual_source_route_remove(route);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+// Callback registered via template_contribution
+void xncp_common_message_sent_cb(sl_status_t status,
+                                 sl_zigbee_outgoing_message_type_t type,
+                                 uint16_t indexOrDestination,
+                                 sl_zigbee_aps_frame_t *apsFrame,
+                                 uint16_t messageTag,
+                                 uint8_t messageLength,
+                                 uint8_t *message)
+{
+    (void)apsFrame;
+    (void)messageLength;
+    (void)message;
+
+    send_benchmark_message_sent(status, messageTag);
+
+    switch (type) {
+        case SL_ZIGBEE_OUTGOING_DIRECT:
+        case SL_ZIGBEE_OUTGOING_VIA_ADDRESS_TABLE:
+        case SL_ZIGBEE_OUTGOING_VIA_BINDING:
+            memory_stats_aps_unicast_completed();
+            break;
+        default:
+            // Broadcasts and multicasts stay in the broadcast table after being sent
+            if (status == SL_STATUS_OK) {
+                memory_stats_broadcast_seen();
+            }
+            break;
+    }
+
+    if ((status == SL_STATUS_OK) || (type != SL_ZIGBEE_OUTGOING_DIRECT)) {
+        return;
+    }
+
+    ManualSourceRoute *route = manual_source_route_get(indexOrDestination);
+
+    if ((route != NULL) && (route->failures < UINT8_MAX)) {
+        route->failures++;
+    }
+}
+
+// Callback registered via template_contribution
+void xncp_common_incoming_route_error_cb(sl_status_t status, sl_802154_short_addr_t target)
+{
+    (void)status;
+
+    // The path is broken, let the host supply a new one
+    ManualSourceRoute *route = manual_source_route_get(target);
+
+    if (route != NULL) {
+        manual_source_route_remove(route);
+    }
+}
+
+// Callback registered via template_contribution
+void xncp_common_stack_status_cb(sl_status_t status)
+{
+    // Routes are meaningless once we leave the network
+    if (status == SL_STATUS_NETWORK_DOWN) {
+        manual_source_route_clear();
+        address_cache_clear();
+        neighbor_stats_clear();
+    }
+}
+
 //------------------------------------------------------------------------------
 // Route table management (XNCP_FEATURE_RESTORE_ROUTE_TABLE)
 //------------------------------------------------------------------------------
 
-static bool handle_set_route_table_entry(xncp_context_t *ctx)
+// destination(2) nextHop(2) status(1) cost(1)
+static void read_route_table_entry(xncp_reader_t *reader, sli_zigbee_route_table_entry_t *entry)
+{
+    entry->destination = xncp_read_u16(reader);
+    entry->nextHop = xncp_read_u16(reader);
+    entry->status = xncp_read_u8(reader);
+    entry->cost = xncp_read_u8(reader);
+    entry->networkIndex = 0;
+}
+
+static void append_route_table_entry(xncp_context_t *ctx, const sli_zigbee_route_table_entry_t *entry)
+{
+    xncp_reply_put_u16(ctx, entry->destination);
+    xncp_reply_put_u16(ctx, entry->nextHop);
+    xncp_reply_put_u8(ctx, entry->status);
+    xncp_reply_put_u8(ctx, entry->cost);
+}
+
+bool xncp_handle_set_route_table_entry(xncp_context_t *ctx)
 {
     if (ctx->payload_length != 7) {
         *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
         return true;
     }
 
-    uint8_t route_table_index = ctx->payload[0];
+    xncp_reader_t reader = xncp_payload_reader(ctx);
+
+    uint8_t route_table_index = xncp_read_u8(&reader);
     if (route_table_index >= sli_zigbee_route_table_size) {
         *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
         return true;
     }
 
-    sli_zigbee_route_table_entry_t *entry = &sli_zigbee_route_table[route_table_index];
-    entry->destination = BUILD_UINT16(ctx->payload[1], ctx->payload[2]);
-    entry->nextHop = BUILD_UINT16(ctx->payload[3], ctx->payload[4]);
-    entry->status = ctx->payload[5];
-    entry->cost = ctx->payload[6];
-    entry->networkIndex = 0;
+    // The host knows what it wrote, only journal what the stack changed before
+    route_table_journal_update();
+    read_route_table_entry(&reader, &sli_zigbee_route_table[route_table_index]);
+    route_table_journal_accept(route_table_index);
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
-static bool handle_get_route_table_entry(xncp_context_t *ctx)
+bool xncp_handle_get_route_table_entry(xncp_context_t *ctx)
 {
     if (ctx->payload_length != 1) {
         *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
@@ -275,26 +773,257 @@ static bool handle_get_route_table_entry(xncp_context_t *ctx)
         return true;
     }
 
-    sli_zigbee_route_table_entry_t *entry = &sli_zigbee_route_table[route_table_index];
+    append_route_table_entry(ctx, &sli_zigbee_route_table[route_table_index]);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Bulk route table transfer (XNCP_FEATURE_ROUTE_TABLE_BULK)
+//------------------------------------------------------------------------------
+
+// index(1) + destination(2) + nextHop(2) + status(1) + cost(1)
+#define ROUTE_TABLE_BULK_ENTRY_SIZE 7
+
+// table_size(1) + generation(2)
+#define ROUTE_TABLE_BULK_INFO_SIZE 3
+
+#define XNCP_ROUTE_TABLE_BULK_FLAG_SKIP_UNUSED (1 << 0)
+
+#if XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
+// The generation is the low half of the journal's latest sequence number, so both
+// commands see the same changes. See route_table_journal.c for how they are found.
+static uint16_t get_route_table_generation(void)
+{
+    route_table_journal_update();
+    return (uint16_t)route_table_journal_get_latest_sequence();
+}
+
+#else
+
+static uint32_t route_table_fingerprint;
+static uint16_t route_table_generation;
+
+// Without the journal there is no shadow copy to diff against, so changes are detected
+// by fingerprinting the fields we expose whenever the host asks for the generation.
+// Entries the host writes advance it too.
+static uint16_t get_route_table_generation(void)
+{
+    uint32_t hash = 2166136261UL;  // FNV-1a
+
+    for (uint8_t i = 0; i < sli_zigbee_route_table_size; i++) {
+        const sli_zigbee_route_table_entry_t *entry = &sli_zigbee_route_table[i];
+        const uint8_t fields[6] = {
+            (uint8_t)(entry->destination >> 0), (uint8_t)(entry->destination >> 8),
+            (uint8_t)(entry->nextHop >> 0), (uint8_t)(entry->nextHop >> 8),
+            entry->status, entry->cost
+        };
+
+        for (uint8_t j = 0; j < sizeof(fields); j++) {
+            hash = (hash ^ fields[j]) * 16777619UL;
+        }
+    }
+
+    if (hash != route_table_fingerprint) {
+        route_table_fingerprint = hash;
+        route_table_generation++;
+    }
+
+    return route_table_generation;
+}
+
+#endif // XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
+static void append_route_table_info(xncp_context_t *ctx)
+{
+    uint16_t generation = get_route_table_generation();
+
+    xncp_reply_put_u8(ctx, sli_zigbee_route_table_size);
+    xncp_reply_put_u16(ctx, generation);
+}
+
+// Request:  start_index(1) flags(1)
+// Response: table_size(1) generation(2) next_index(1) count(1) [index(1) destination(2)
+//           nextHop(2) status(1) cost(1)]*
+//
+// Fills the reply with as many entries as fit, starting at `start_index`. The host
+// pages through the table by passing back `next_index` until it equals `table_size`,
+// and restarts if `generation` changed between pages.
+bool xncp_handle_get_route_table_range(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 2) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    uint8_t index = ctx->payload[0];
+    uint8_t flags = ctx->payload[1];
+
+    if (index > sli_zigbee_route_table_size) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    append_route_table_info(ctx);
+
+    uint8_t *header = xncp_reply_reserve(ctx, 2);
+    if (header == NULL) {
+        return true;
+    }
+
+    uint8_t *next_index = &header[0];
+    uint8_t *count = &header[1];
+    *count = 0;
+
+    for (; index < sli_zigbee_route_table_size; index++) {
+        sli_zigbee_route_table_entry_t *entry = &sli_zigbee_route_table[index];
+
+        if ((flags & XNCP_ROUTE_TABLE_BULK_FLAG_SKIP_UNUSED) && (entry->status == ROUTE_UNUSED)) {
+            continue;
+        }
+
+        if (xncp_reply_remaining(ctx) < ROUTE_TABLE_BULK_ENTRY_SIZE) {
+            break;
+        }
+
+        xncp_reply_put_u8(ctx, index);
+        append_route_table_entry(ctx, entry);
+        (*count)++;
+    }
+
+    *next_index = index;
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+// Request:  [index(1) destination(2) nextHop(2) status(1) cost(1)]*
+// Response: table_size(1) generation(2)
+//
+// Entries are validated before any of them is written, so a bad index leaves the
+// table untouched. Written entries are not journaled: however many are restored, the
+// host can keep syncing with get_route_table_changes from the returned generation.
+bool xncp_handle_set_route_table_range(xncp_context_t *ctx)
+{
+    if (ctx->payload_length % ROUTE_TABLE_BULK_ENTRY_SIZE != 0) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    for (uint8_t offset = 0; offset < ctx->payload_length; offset += ROUTE_TABLE_BULK_ENTRY_SIZE) {
+        if (ctx->payload[offset] >= sli_zigbee_route_table_size) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+    }
+
+    route_table_journal_update();
+
+    xncp_reader_t reader = xncp_payload_reader(ctx);
+
+    while (xncp_reader_has_more(&reader)) {
+        uint8_t index = xncp_read_u8(&reader);
+        read_route_table_entry(&reader, &sli_zigbee_route_table[index]);
+        route_table_journal_accept(index);
+    }
+
+    append_route_table_info(ctx);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Route table journal (XNCP_FEATURE_ROUTE_TABLE_JOURNAL)
+//------------------------------------------------------------------------------
+
+#if XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
+// index(1) + destination(2) + old_next_hop(2) + new_next_hop(2) + status(1) + cost(1)
+#define ROUTE_TABLE_CHANGE_SIZE 9
+
+#define XNCP_ROUTE_TABLE_JOURNAL_FLAG_OVERFLOW (1 << 0)
+
+// Request:  since_sequence(4)
+// Response: flags(1) epoch(2) latest_sequence(4) first_sequence(4) count(1)
+//           [index(1) destination(2) old_next_hop(2) new_next_hop(2) status(1) cost(1)]*
+//
+// Returns the changes made after `since_sequence`, oldest first, starting at
+// `first_sequence`. The host repeats the request with the last sequence it received
+// until it reaches `latest_sequence`.
+//
+// To start syncing, the host reads `epoch` and `latest_sequence`, then reads the whole
+// table with `get_route_table_range`. Changes made in between are returned again,
+// which is harmless since every change carries the full new entry. If the overflow
+// flag is set or `epoch` changed, the host must read the whole table again.
+//
+// Changes are only detected when the host polls, so several changes to one entry
+// between two polls are coalesced into one, from the state at the previous poll to the
+// current one. Intermediate states are never reported. Entries the host writes with
+// set_route_table_entry or set_route_table_range are not reported either.
+bool xncp_handle_get_route_table_changes(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 4) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    xncp_reader_t reader = xncp_payload_reader(ctx);
+    uint32_t since = xncp_read_u32(&reader);
+
+    route_table_journal_update();
 
-    ctx->reply[(*ctx->reply_length)++] = (entry->destination & 0x00FF) >> 0;
-    ctx->reply[(*ctx->reply_length)++] = (entry->destination & 0xFF00) >> 8;
+    uint16_t epoch = route_table_journal_get_epoch();
+    uint32_t latest = route_table_journal_get_latest_sequence();
+    uint32_t sequence = since + 1;
+    uint8_t flags = 0;
 
-    ctx->reply[(*ctx->reply_length)++] = (entry->nextHop & 0x00FF) >> 0;
-    ctx->reply[(*ctx->reply_length)++] = (entry->nextHop & 0xFF00) >> 8;
+    if ((since > latest) || ((since < latest) && (route_table_journal_get(sequence) == NULL))) {
+        flags |= XNCP_ROUTE_TABLE_JOURNAL_FLAG_OVERFLOW;
+        sequence = latest + 1;
+    }
+
+    xncp_reply_put_u8(ctx, flags);
+    xncp_reply_put_u16(ctx, epoch);
+    xncp_reply_put_u32(ctx, latest);
+    xncp_reply_put_u32(ctx, sequence);
 
-    ctx->reply[(*ctx->reply_length)++] = entry->status;
-    ctx->reply[(*ctx->reply_length)++] = entry->cost;
+    uint8_t *count = xncp_reply_reserve(ctx, 1);
+    if (count == NULL) {
+        return true;
+    }
+
+    *count = 0;
+
+    for (; sequence <= latest; sequence++) {
+        if (xncp_reply_remaining(ctx) < ROUTE_TABLE_CHANGE_SIZE) {
+            break;
+        }
+
+        const RouteTableChange *change = route_table_journal_get(sequence);
+
+        xncp_reply_put_u8(ctx, change->index);
+        xncp_reply_put_u16(ctx, change->destination);
+        xncp_reply_put_u16(ctx, change->old_next_hop);
+        xncp_reply_put_u16(ctx, change->new_next_hop);
+        xncp_reply_put_u8(ctx, change->status);
+        xncp_reply_put_u8(ctx, change->cost);
+        (*count)++;
+    }
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
+#endif // XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+
 //------------------------------------------------------------------------------
 // Token and info commands
 //------------------------------------------------------------------------------
 
-static bool handle_get_mfg_token_override(xncp_context_t *ctx)
+bool xncp_handle_get_mfg_token_override(xncp_context_t *ctx)
 {
     if (ctx->payload_length != 1) {
         *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
@@ -318,25 +1047,21 @@ static bool handle_get_mfg_token_override(xncp_context_t *ctx)
             return true;
     }
 
-    uint8_t value_length = strlen(override_value);
-    memcpy(ctx->reply + *ctx->reply_length, override_value, value_length);
-    *ctx->reply_length += value_length;
+    xncp_reply_put_bytes(ctx, override_value, strlen(override_value));
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
-static bool handle_get_build_string(xncp_context_t *ctx)
+bool xncp_handle_get_build_string(xncp_context_t *ctx)
 {
-    uint8_t value_length = strlen(XNCP_BUILD_STRING);
-    memcpy(ctx->reply + *ctx->reply_length, XNCP_BUILD_STRING, value_length);
-    *ctx->reply_length += value_length;
+    xncp_reply_put_bytes(ctx, XNCP_BUILD_STRING, strlen(XNCP_BUILD_STRING));
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
-static bool handle_get_flow_control_type(xncp_context_t *ctx)
+bool xncp_handle_get_flow_control_type(xncp_context_t *ctx)
 {
     XncpFlowControlType flow_control_type;
 
@@ -351,33 +1076,28 @@ static bool handle_get_flow_control_type(xncp_context_t *ctx)
             break;
     }
 
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)(flow_control_type & 0xFF);
+    xncp_reply_put_u8(ctx, (uint8_t)(flow_control_type & 0xFF));
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
-static bool handle_get_chip_info(xncp_context_t *ctx)
+bool xncp_handle_get_chip_info(xncp_context_t *ctx)
 {
     // RAM size
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((RAM_MEM_SIZE >>  0) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((RAM_MEM_SIZE >>  8) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((RAM_MEM_SIZE >> 16) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((RAM_MEM_SIZE >> 24) & 0xFF);
+    xncp_reply_put_u32(ctx, RAM_MEM_SIZE);
 
     // Part number
     uint8_t value_length = strlen(PART_NUMBER);
-    ctx->reply[(*ctx->reply_length)++] = value_length;
-
-    memcpy(ctx->reply + *ctx->reply_length, PART_NUMBER, value_length);
-    *ctx->reply_length += value_length;
+    xncp_reply_put_u8(ctx, value_length);
+    xncp_reply_put_bytes(ctx, PART_NUMBER, value_length);
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
 }
 
 
-static bool handle_get_tx_power_info(xncp_context_t *ctx)
+bool xncp_handle_get_tx_power_info(xncp_context_t *ctx)
 {
     if (ctx->payload_length != 2) {
       *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
@@ -388,47 +1108,57 @@ static bool handle_get_tx_power_info(xncp_context_t *ctx)
     get_tx_power_for_country(ctx->payload[0], ctx->payload[1], &result);
 
     *ctx->status = XNCP_STATUS_OK;
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)result.recommended_power_dbm;
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)result.max_power_dbm;
+    xncp_reply_put_u8(ctx, (uint8_t)result.recommended_power_dbm);
+    xncp_reply_put_u8(ctx, (uint8_t)result.max_power_dbm);
 
     return true;
 }
 
-//------------------------------------------------------------------------------
-// Combined send (XNCP_FEATURE_COMBINED_SEND)
-//------------------------------------------------------------------------------
-
-// Mirrors the host `set_extended_timeout` logic locally: skip if already set,
-// otherwise set it, creating an address table entry first if none exists.
-static void apply_extended_timeout(uint8_t *eui64, uint16_t node_id, bool extended_timeout)
+// Request:  country_code(2)
+// Response: recommended_dbm(1) max_dbm(1) phy_count(1)
+//           [phy(1) first_channel(1) channel_count(1) max_dbm(1)*channel_count]*
+//
+// Countries without an entry get the configured defaults, like get_tx_power_info
+bool xncp_handle_get_tx_power_profile(xncp_context_t *ctx)
 {
-    bool current = (sl_zigbee_get_extended_timeout(eui64) == SL_STATUS_OK);
-    if (current == extended_timeout) {
-        return;
+    if (ctx->payload_length != 2) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
     }
 
-    sl_802154_short_addr_t existing_node_id;
-    if ((sl_zigbee_lookup_node_id_by_eui64(eui64, &existing_node_id) == SL_STATUS_OK)
-        && (existing_node_id != SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID)) {
-        sl_zigbee_set_extended_timeout(eui64, extended_timeout);
-        return;
-    }
+    CountryTxPower result;
+    get_tx_power_for_country(ctx->payload[0], ctx->payload[1], &result);
+
+    xncp_reply_put_u8(ctx, (uint8_t)result.recommended_power_dbm);
+    xncp_reply_put_u8(ctx, (uint8_t)result.max_power_dbm);
 
-    // No address table entry exists; replace a random one so the timeout sticks
-    uint8_t index = xncp_get_pseudo_random_number() % sli_zigbee_address_table_size;
-    sl_zigbee_set_address_table_info(index, eui64, node_id);
-    sl_zigbee_set_extended_timeout(eui64, extended_timeout);
+    // Only the 2.4 GHz O-QPSK PHY is supported for now
+    xncp_reply_put_u8(ctx, 1);
+    xncp_reply_put_u8(ctx, XNCP_TX_POWER_PHY_2P4GHZ_OQPSK);
+    xncp_reply_put_u8(ctx, TX_POWER_FIRST_CHANNEL);
+    xncp_reply_put_u8(ctx, TX_POWER_CHANNEL_COUNT);
+    xncp_reply_put_bytes(ctx, result.channel_max_power_dbm, TX_POWER_CHANNEL_COUNT);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
 }
 
-static bool handle_send_unicast(xncp_context_t *ctx)
+//------------------------------------------------------------------------------
+// Combined send (XNCP_FEATURE_COMBINED_SEND)
+//------------------------------------------------------------------------------
+
+// Parses a combined send request and sends it. Returns false if the request is
+// malformed, in which case nothing was sent.
+static bool parse_and_send_unicast(uint8_t *p,
+                                   uint8_t length,
+                                   sl_status_t *status,
+                                   uint8_t *aps_sequence)
 {
-    uint8_t *p = ctx->payload;
-    uint8_t *end = ctx->payload + ctx->payload_length;
+    uint8_t *end = p + length;
 
     // flags(1) + destination(2) + aps_frame(11) + message_tag(1)
     if ((end - p) < 15) {
-        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
-        return true;
+        return false;
     }
 
     uint8_t flags = *p++;
@@ -450,43 +1180,144 @@ static bool handle_send_unicast(xncp_context_t *ctx)
 
     if (flags & XNCP_SEND_UNICAST_FLAG_EXTENDED_TIMEOUT) {
         if ((end - p) < 9) {
-            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
-            return true;
+            return false;
         }
         uint8_t *eui64 = p;
         p += 8;
         bool extended_timeout = (*p++ != 0);
-        apply_extended_timeout(eui64, destination, extended_timeout);
+        address_cache_set_extended_timeout(eui64, destination, extended_timeout);
     }
 
     if (flags & XNCP_SEND_UNICAST_FLAG_SOURCE_ROUTE) {
         if ((end - p) < 1) {
-            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
-            return true;
+            return false;
         }
         uint8_t num_relays = *p++;
         if ((num_relays > XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT)
             || ((end - p) < (num_relays * 2))) {
-            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
-            return true;
+            return false;
         }
-        install_manual_source_route(destination, p, num_relays);
+        manual_source_route_install(destination, p, num_relays,
+                                    legacy_source_route_max_uses(num_relays), 0);
         p += num_relays * 2;
     }
 
     uint8_t message_length = (uint8_t)(end - p);
 
-    uint8_t aps_sequence = 0;
-    sl_status_t status = sl_zigbee_send_unicast(SL_ZIGBEE_OUTGOING_DIRECT,
-                                                destination, &aps_frame, message_tag,
-                                                message_length, p, &aps_sequence);
+    *aps_sequence = 0;
+    *status = sl_zigbee_send_unicast(SL_ZIGBEE_OUTGOING_DIRECT,
+                                     destination, &aps_frame, message_tag,
+                                     message_length, p, aps_sequence);
+    return true;
+}
+
+static void append_send_result(xncp_context_t *ctx, sl_status_t status, uint8_t aps_sequence)
+{
+    xncp_reply_put_u32(ctx, status);
+    xncp_reply_put_u8(ctx, aps_sequence);
+}
+
+bool xncp_handle_send_unicast(xncp_context_t *ctx)
+{
+    sl_status_t status;
+    uint8_t aps_sequence;
+
+    if (!parse_and_send_unicast(ctx->payload, ctx->payload_length, &status, &aps_sequence)) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    append_send_result(ctx, status, aps_sequence);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Batched send (XNCP_FEATURE_BATCH_SEND)
+//------------------------------------------------------------------------------
+
+// status(4) + aps_sequence(1)
+#define SEND_RESULT_SIZE 5
+
+// Request:  [length(1) send_unicast_request(length)]*
+// Response: count(1) [status(4) aps_sequence(1)]*
+//
+// Each request uses the `send_unicast` format. Messages are sent in order until the
+// APS unicast message pool is exhausted; the result that hit the limit is included
+// and `count` tells the host how many requests were consumed. Malformed requests are
+// reported as SL_STATUS_INVALID_PARAMETER without stopping the batch.
+bool xncp_handle_send_unicast_batch(xncp_context_t *ctx)
+{
+    // Validate the framing up front so a malformed batch sends nothing
+    for (uint8_t offset = 0; offset < ctx->payload_length; offset += 1 + ctx->payload[offset]) {
+        if ((ctx->payload_length - offset - 1) < ctx->payload[offset]) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+    }
+
+    uint8_t *count = xncp_reply_reserve(ctx, 1);
+    if (count == NULL) {
+        return true;
+    }
+
+    *count = 0;
+
+    for (uint8_t offset = 0; offset < ctx->payload_length; offset += 1 + ctx->payload[offset]) {
+        if (xncp_reply_remaining(ctx) < SEND_RESULT_SIZE) {
+            break;
+        }
+
+        sl_status_t status;
+        uint8_t aps_sequence;
+
+        if (!parse_and_send_unicast(&ctx->payload[offset + 1], ctx->payload[offset],
+                                    &status, &aps_sequence)) {
+            status = SL_STATUS_INVALID_PARAMETER;
+            aps_sequence = 0;
+        }
 
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((status >>  0) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((status >>  8) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((status >> 16) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = (uint8_t)((status >> 24) & 0xFF);
-    ctx->reply[(*ctx->reply_length)++] = aps_sequence;
+        append_send_result(ctx, status, aps_sequence);
+        (*count)++;
+
+        if ((status == SL_STATUS_ZIGBEE_MAX_MESSAGE_LIMIT_REACHED)
+            || (status == SL_STATUS_ALLOCATION_FAILED)) {
+            break;
+        }
+    }
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------------
+// Address cache statistics (XNCP_FEATURE_ADDRESS_CACHE_STATS)
+//------------------------------------------------------------------------------
+
+#define XNCP_ADDRESS_CACHE_STATS_FLAG_RESET (1 << 0)
+
+// Request:  flags(1)
+// Response: lookups(4) hits(4) inserts(4) evictions(4)
+//
+// The counters are read before they are reset, so a poller never loses any counts.
+bool xncp_handle_get_address_cache_stats(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 1) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    const AddressCacheStats *stats = address_cache_get_stats();
+    xncp_reply_put_u32(ctx, stats->lookups);
+    xncp_reply_put_u32(ctx, stats->hits);
+    xncp_reply_put_u32(ctx, stats->inserts);
+    xncp_reply_put_u32(ctx, stats->evictions);
+
+    if (ctx->payload[0] & XNCP_ADDRESS_CACHE_STATS_FLAG_RESET) {
+        address_cache_reset_stats();
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
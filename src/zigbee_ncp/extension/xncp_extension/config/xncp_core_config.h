@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ * @file
+ * @brief Configuration header for XNCP Core
+ ******************************************************************************/
+#ifndef XNCP_CORE_CONFIG_H_
+#define XNCP_CORE_CONFIG_H_
+
+// Options used as an `xncp_command` or `xncp_feature` condition belong in this file:
+// it is the only configuration header the generated dispatcher includes.
+
+// <<< Use Configuration Wizard in Context Menu >>>
+
+// <h>XNCP Core Configuration
+
+// <q XNCP_PERF_COUNTERS_ENABLED> Performance counters
+// <i> Count XNCP command invocations and time handlers with the DWT cycle counter.
+// <i> Compiled out entirely when disabled.
+// <i> Default: 0
+#ifndef XNCP_PERF_COUNTERS_ENABLED
+#define XNCP_PERF_COUNTERS_ENABLED 0
+#endif
+
+// <o XNCP_PERF_MAX_COMMANDS> Number of commands tracked by the performance counters <1-64>
+// <i> Commands beyond this limit are only counted in the frame totals
+// <i> Default: 16
+#ifndef XNCP_PERF_MAX_COMMANDS
+#define XNCP_PERF_MAX_COMMANDS 16
+#endif
+
+// <q XNCP_SEND_BENCHMARK_ENABLED> Send benchmark
+// <i> Commands that offer unicasts to the combined send path at a fixed rate and
+// <i> measure enqueue latency, APS queue and packet buffer heap usage. Only meant for
+// <i> test builds. Compiled out entirely when disabled.
+// <i> Default: 0
+#ifndef XNCP_SEND_BENCHMARK_ENABLED
+#define XNCP_SEND_BENCHMARK_ENABLED 0
+#endif
+
+// <q XNCP_ROUTE_TABLE_JOURNAL_ENABLED> Route table journal
+// <i> Journal route table changes for incremental host sync. Keeps a shadow copy of
+// <i> the route table. When disabled, the route table generation is a fingerprint of
+// <i> the table instead.
+// <i> Default: 0
+#ifndef XNCP_ROUTE_TABLE_JOURNAL_ENABLED
+#define XNCP_ROUTE_TABLE_JOURNAL_ENABLED 0
+#endif
+
+// <q XNCP_INCOMING_FILTER_ENABLED> Incoming message filter
+// <i> Drop rules and attribute report deduplication for incoming APS frames
+// <i> Default: 0
+#ifndef XNCP_INCOMING_FILTER_ENABLED
+#define XNCP_INCOMING_FILTER_ENABLED 0
+#endif
+
+// <q XNCP_NEIGHBOR_STATS_ENABLED> Neighbor statistics
+// <i> Per-neighbor link quality and MAC delivery statistics
+// <i> Default: 0
+#ifndef XNCP_NEIGHBOR_STATS_ENABLED
+#define XNCP_NEIGHBOR_STATS_ENABLED 0
+#endif
+
+// <q XNCP_MEMORY_STATS_ENABLED> Memory statistics
+// <i> Current and peak usage of stack pools and buffers
+// <i> Default: 0
+#ifndef XNCP_MEMORY_STATS_ENABLED
+#define XNCP_MEMORY_STATS_ENABLED 0
+#endif
+
+// <o XNCP_NOTIFY_QUEUE_SIZE> Notification queue size <1-255>
+// <i> Notifications waiting to be sent to the host. When full, lower priority
+// <i> notifications are dropped first.
+// <i> Default: 8
+#ifndef XNCP_NOTIFY_QUEUE_SIZE
+#define XNCP_NOTIFY_QUEUE_SIZE 8
+#endif
+
+// <o XNCP_NOTIFY_MAX_PAYLOAD_LENGTH> Maximum notification payload length <1-100>
+// <i> Default: 16
+#ifndef XNCP_NOTIFY_MAX_PAYLOAD_LENGTH
+#define XNCP_NOTIFY_MAX_PAYLOAD_LENGTH 16
+#endif
+
+// </h>
+
+// <<< end of configuration section >>>
+
+#endif // XNCP_CORE_CONFIG_H_
@@ -0,0 +1,179 @@
+/*
+ * xncp_buffer.h
+ *
+ * Bounds checked reply writer and payload reader for XNCP handlers
+ *
+ * The writer appends straight into the reply buffer the frame is sent from. A write
+ * that does not fit writes nothing and marks the reply as overflowed, as does every
+ * write after it. The core then discards the reply and answers XNCP_STATUS_OVERFLOW,
+ * so handlers only check the result where they want to stop early, e.g. to fill a
+ * frame with as many table entries as fit.
+ *
+ * The reader works the same way: reading past the end yields zeros and sets a sticky
+ * error, checked once after parsing. All values are little endian.
+ */
+
+#ifndef XNCP_BUFFER_H
+#define XNCP_BUFFER_H
+
+#include "xncp_types.h"
+
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Reply writer
+//------------------------------------------------------------------------------
+
+static inline uint8_t xncp_reply_remaining(const xncp_context_t *ctx)
+{
+    return ctx->reply_overflow ? 0 : (uint8_t)(ctx->reply_capacity - *ctx->reply_length);
+}
+
+// Appends `length` bytes for the caller to fill in, or returns NULL if they do not fit
+static inline uint8_t* xncp_reply_reserve(xncp_context_t *ctx, uint8_t length)
+{
+    if (xncp_reply_remaining(ctx) < length) {
+        ctx->reply_overflow = true;
+        return NULL;
+    }
+
+    uint8_t *p = ctx->reply + *ctx->reply_length;
+    *ctx->reply_length += length;
+    return p;
+}
+
+static inline bool xncp_reply_put_u8(xncp_context_t *ctx, uint8_t value)
+{
+    uint8_t *p = xncp_reply_reserve(ctx, 1);
+
+    if (p == NULL) {
+        return false;
+    }
+
+    p[0] = value;
+    return true;
+}
+
+static inline bool xncp_reply_put_u16(xncp_context_t *ctx, uint16_t value)
+{
+    uint8_t *p = xncp_reply_reserve(ctx, 2);
+
+    if (p == NULL) {
+        return false;
+    }
+
+    p[0] = (uint8_t)((value >> 0) & 0xFF);
+    p[1] = (uint8_t)((value >> 8) & 0xFF);
+    return true;
+}
+
+static inline bool xncp_reply_put_u32(xncp_context_t *ctx, uint32_t value)
+{
+    uint8_t *p = xncp_reply_reserve(ctx, 4);
+
+    if (p == NULL) {
+        return false;
+    }
+
+    p[0] = (uint8_t)((value >>  0) & 0xFF);
+    p[1] = (uint8_t)((value >>  8) & 0xFF);
+    p[2] = (uint8_t)((value >> 16) & 0xFF);
+    p[3] = (uint8_t)((value >> 24) & 0xFF);
+    return true;
+}
+
+static inline bool xncp_reply_put_bytes(xncp_context_t *ctx, const void *data, uint8_t length)
+{
+    uint8_t *p = xncp_reply_reserve(ctx, length);
+
+    if (p == NULL) {
+        return false;
+    }
+
+    memcpy(p, data, length);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Payload reader
+//------------------------------------------------------------------------------
+
+typedef struct {
+    const uint8_t *data;
+    uint8_t remaining;
+    bool error;
+} xncp_reader_t;
+
+static inline void xncp_reader_init(xncp_reader_t *reader, const uint8_t *data, uint8_t length)
+{
+    reader->data = data;
+    reader->remaining = length;
+    reader->error = false;
+}
+
+static inline xncp_reader_t xncp_payload_reader(const xncp_context_t *ctx)
+{
+    xncp_reader_t reader;
+    xncp_reader_init(&reader, ctx->payload, ctx->payload_length);
+    return reader;
+}
+
+// True if nothing was read past the end
+static inline bool xncp_reader_ok(const xncp_reader_t *reader)
+{
+    return !reader->error;
+}
+
+// True if there is still something to read, for parsing repeated entries
+static inline bool xncp_reader_has_more(const xncp_reader_t *reader)
+{
+    return !reader->error && (reader->remaining > 0);
+}
+
+// True if the payload was consumed exactly
+static inline bool xncp_reader_done(const xncp_reader_t *reader)
+{
+    return !reader->error && (reader->remaining == 0);
+}
+
+// Returns `length` bytes in place, or NULL if fewer are left
+static inline const uint8_t* xncp_read_bytes(xncp_reader_t *reader, uint8_t length)
+{
+    if (reader->error || (reader->remaining < length)) {
+        reader->error = true;
+        return NULL;
+    }
+
+    const uint8_t *p = reader->data;
+    reader->data += length;
+    reader->remaining -= length;
+    return p;
+}
+
+static inline uint8_t xncp_read_u8(xncp_reader_t *reader)
+{
+    const uint8_t *p = xncp_read_bytes(reader, 1);
+    return (p == NULL) ? 0 : p[0];
+}
+
+static inline uint16_t xncp_read_u16(xncp_reader_t *reader)
+{
+    const uint8_t *p = xncp_read_bytes(reader, 2);
+    return (p == NULL) ? 0 : (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t xncp_read_u32(xncp_reader_t *reader)
+{
+    const uint8_t *p = xncp_read_bytes(reader, 4);
+
+    if (p == NULL) {
+        return 0;
+    }
+
+    return (uint32_t)p[0]
+           | ((uint32_t)p[1] << 8)
+           | ((uint32_t)p[2] << 16)
+           | ((uint32_t)p[3] << 24);
+}
+
+#endif // XNCP_BUFFER_H
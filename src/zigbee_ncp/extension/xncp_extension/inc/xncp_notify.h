@@ -0,0 +1,47 @@
+/*
+ * xncp_notify.h
+ *
+ * XNCP notifications (XNCP_FEATURE_NOTIFICATIONS)
+ *
+ * NCP-originated events pushed to the host as custom EZSP frames, for the event
+ * types the host subscribed to.
+ */
+
+#ifndef XNCP_NOTIFY_H
+#define XNCP_NOTIFY_H
+
+#include "xncp_types.h"
+
+// Event types are bits of the subscription mask. Extensions own a range each:
+//   0x00-0x0F: common commands
+//   0x10-0x1F: board specific commands
+#define XNCP_NOTIFY_MAX_EVENT_TYPES 32
+
+// Higher priorities are sent first and evict lower ones when the queue is full
+typedef enum {
+    XNCP_NOTIFY_PRIORITY_LOW = 0,
+    XNCP_NOTIFY_PRIORITY_NORMAL,
+    XNCP_NOTIFY_PRIORITY_HIGH,
+} xncp_notify_priority_t;
+
+// Queue a notification, returns false if the host is not subscribed or it was dropped.
+// Must be called from the main loop, not from interrupt context.
+//
+// When the host set a minimum interval for the event type, a notification of the same
+// type still waiting in the queue is updated in place and the host only sees the
+// latest value.
+bool xncp_notify(uint8_t event_type,
+                 xncp_notify_priority_t priority,
+                 const uint8_t *payload,
+                 uint8_t length);
+
+// Lets producers skip sampling for events nobody listens to
+bool xncp_notify_is_subscribed(uint8_t event_type);
+uint16_t xncp_notify_get_min_interval(uint8_t event_type);
+
+// Main loop process action, sends at most one queued notification per pass
+void xncp_notify_process_action(void);
+
+bool xncp_handle_set_notifications(xncp_context_t *ctx);
+
+#endif // XNCP_NOTIFY_H
@@ -0,0 +1,39 @@
+/*
+ * xncp_perf.h
+ *
+ * XNCP performance counters (XNCP_FEATURE_PERF_COUNTERS)
+ *
+ * Enabled with XNCP_PERF_COUNTERS_ENABLED. When disabled the hooks below expand to
+ * nothing and the get command is not registered.
+ */
+
+#ifndef XNCP_PERF_H
+#define XNCP_PERF_H
+
+#include "xncp_types.h"
+
+// Frame latency histogram, bucket N counts frames that took [2^(N+6), 2^(N+7)) cycles.
+// The first and last buckets are open ended.
+#define XNCP_PERF_HISTOGRAM_BUCKETS 16
+
+#if XNCP_PERF_COUNTERS_ENABLED
+
+uint32_t xncp_perf_start(void);
+void xncp_perf_record_command(uint16_t command_id, uint32_t start);
+void xncp_perf_record_frame(uint32_t start);
+
+bool xncp_handle_get_perf_counters(xncp_context_t *ctx);
+
+#define XNCP_PERF_START(start)                       uint32_t start = xncp_perf_start()
+#define XNCP_PERF_RECORD_COMMAND(command_id, start)  xncp_perf_record_command((command_id), (start))
+#define XNCP_PERF_RECORD_FRAME(start)                xncp_perf_record_frame(start)
+
+#else
+
+#define XNCP_PERF_START(start)
+#define XNCP_PERF_RECORD_COMMAND(command_id, start)
+#define XNCP_PERF_RECORD_FRAME(start)
+
+#endif // XNCP_PERF_COUNTERS_ENABLED
+
+#endif // XNCP_PERF_H
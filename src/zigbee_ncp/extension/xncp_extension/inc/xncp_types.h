@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "xncp_core_config.h"
+
 // SDK compatibility layer
 #ifdef STACK_TYPES_HEADER
 // Simplicity SDK (2025.x)
@@ -21,6 +23,7 @@ typedef sl_status_t xncp_status_t;
 #define XNCP_STATUS_OK           SL_STATUS_OK
 #define XNCP_STATUS_BAD_ARGUMENT SL_STATUS_INVALID_PARAMETER
 #define XNCP_STATUS_NOT_FOUND    SL_STATUS_NOT_FOUND
+#define XNCP_STATUS_OVERFLOW     SL_STATUS_WOULD_OVERFLOW
 
 #define XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT SL_ZIGBEE_MAX_SOURCE_ROUTE_RELAY_COUNT
 
@@ -39,6 +42,7 @@ typedef EmberStatus xncp_status_t;
 #define XNCP_STATUS_OK           EMBER_SUCCESS
 #define XNCP_STATUS_BAD_ARGUMENT EMBER_BAD_ARGUMENT
 #define XNCP_STATUS_NOT_FOUND    EMBER_NOT_FOUND
+#define XNCP_STATUS_OVERFLOW     EMBER_MESSAGE_TOO_LONG
 
 #define XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT EMBER_MAX_SOURCE_ROUTE_RELAY_COUNT
 
@@ -56,48 +60,90 @@ typedef EmberMessageBuffer xncp_message_buffer_t;
 #endif
 
 // Feature flags - components OR these together
-#define XNCP_FEATURE_MEMBER_OF_ALL_GROUPS  (1UL << 0)
-#define XNCP_FEATURE_MANUAL_SOURCE_ROUTE   (1UL << 1)
-#define XNCP_FEATURE_MFG_TOKEN_OVERRIDES   (1UL << 2)
-#define XNCP_FEATURE_BUILD_STRING          (1UL << 3)
-#define XNCP_FEATURE_FLOW_CONTROL_TYPE     (1UL << 4)
-#define XNCP_FEATURE_CHIP_INFO             (1UL << 5)
-#define XNCP_FEATURE_RESTORE_ROUTE_TABLE   (1UL << 6)
-#define XNCP_FEATURE_TX_POWER_INFO         (1UL << 7)
-#define XNCP_FEATURE_COMBINED_SEND         (1UL << 8)
-#define XNCP_FEATURE_LED_CONTROL           (1UL << 31)
+#define XNCP_FEATURE_MEMBER_OF_ALL_GROUPS    (1UL << 0)
+#define XNCP_FEATURE_MANUAL_SOURCE_ROUTE     (1UL << 1)
+#define XNCP_FEATURE_MFG_TOKEN_OVERRIDES     (1UL << 2)
+#define XNCP_FEATURE_BUILD_STRING            (1UL << 3)
+#define XNCP_FEATURE_FLOW_CONTROL_TYPE       (1UL << 4)
+#define XNCP_FEATURE_CHIP_INFO               (1UL << 5)
+#define XNCP_FEATURE_RESTORE_ROUTE_TABLE     (1UL << 6)
+#define XNCP_FEATURE_TX_POWER_INFO           (1UL << 7)
+#define XNCP_FEATURE_COMBINED_SEND           (1UL << 8)
+#define XNCP_FEATURE_MULTI_COMMAND           (1UL << 9)
+#define XNCP_FEATURE_ROUTE_TABLE_BULK        (1UL << 10)
+#define XNCP_FEATURE_PERSISTENT_SOURCE_ROUTE (1UL << 11)
+#define XNCP_FEATURE_BATCH_SEND              (1UL << 12)
+#define XNCP_FEATURE_ADDRESS_CACHE_STATS     (1UL << 13)
+#define XNCP_FEATURE_PERF_COUNTERS           (1UL << 14)
+#define XNCP_FEATURE_ROUTE_TABLE_JOURNAL     (1UL << 15)
+#define XNCP_FEATURE_MULTICAST_FILTER        (1UL << 16)
+#define XNCP_FEATURE_INCOMING_FILTER         (1UL << 17)
+#define XNCP_FEATURE_NOTIFICATIONS           (1UL << 18)
+#define XNCP_FEATURE_TX_POWER_PROFILE        (1UL << 19)
+#define XNCP_FEATURE_NEIGHBOR_STATS          (1UL << 20)
+#define XNCP_FEATURE_SEND_BENCHMARK          (1UL << 21)
+#define XNCP_FEATURE_MEMORY_STATS            (1UL << 22)
+#define XNCP_FEATURE_LED_ANIMATION           (1UL << 29)
+#define XNCP_FEATURE_LED_PIXELS              (1UL << 30)
+#define XNCP_FEATURE_LED_CONTROL             (1UL << 31)
 
 // Base command IDs (extensions define their own in separate headers)
 #define XNCP_CMD_GET_SUPPORTED_FEATURES_REQ 0x0000
+#define XNCP_CMD_MULTI_COMMAND_REQ          0x000A
+#define XNCP_CMD_GET_PERF_COUNTERS_REQ      0x0012
+#define XNCP_CMD_SET_NOTIFICATIONS_REQ      0x0018
 #define XNCP_CMD_UNKNOWN                    0xFFFF
 
 // Response bit - OR with request ID to get response ID
 #define XNCP_CMD_RESPONSE_BIT 0x8000
 
-// Command context passed to handlers
+// Notification bit - OR with the event type to get the ID of an NCP-originated frame
+#define XNCP_CMD_NOTIFICATION_BIT 0x4000
+
+// Size of the XNCP header (command ID + status) at the start of every frame
+#define XNCP_HEADER_LENGTH 3
+
+// Largest custom frame reply, XNCP header included. ASH caps EZSP frames at 128 bytes
+// and the EZSP header and customFrame response fields take up the rest.
+#ifndef XNCP_MAX_REPLY_LENGTH
+#define XNCP_MAX_REPLY_LENGTH 118
+#endif
+
+// Command context passed to handlers. Replies are best written with the bounds
+// checked helpers in xncp_buffer.h, which respect `reply_capacity`.
 typedef struct {
     uint16_t command_id;
     uint8_t *payload;
     uint8_t payload_length;
     uint8_t *reply;
     uint8_t *reply_length;
+    uint8_t reply_capacity;   // Size of `reply`, `*reply_length` never exceeds it
+    bool reply_overflow;      // Set when a write did not fit, the reply is discarded
     uint8_t *status;
     uint16_t *response_id;
 } xncp_context_t;
 
 // Handler function type - returns true if command was handled
+//
+// Components register handlers with an `xncp_command` template contribution:
+//   - name: xncp_command
+//     value:
+//       id: "0x0001"
+//       handler: xncp_handle_set_source_route
+//
+// An optional `condition` wraps the command in `#if <condition>`, so commands that
+// are compiled out can still be contributed. Features take the same condition as
+// `{flag: XNCP_FEATURE_..., condition: ...}`. The generated dispatcher only includes
+// xncp_core_config.h, so conditions have to be defined there.
 typedef bool (*xncp_handler_fn_t)(xncp_context_t *ctx);
 
-// Command definition for dispatch tables (sentinel-terminated with {0, NULL})
-typedef struct {
-    uint16_t command_id;
-    xncp_handler_fn_t handler;
-} xncp_command_def_t;
-
 // Get aggregated feature flags from all handlers (generated)
 uint32_t xncp_get_supported_features(void);
 
 // Dispatch command to handlers (generated)
 bool xncp_dispatch_command(xncp_context_t *ctx);
 
+// Execute a batch of sub-commands in a single frame (XNCP_FEATURE_MULTI_COMMAND)
+bool xncp_handle_multi_command(xncp_context_t *ctx);
+
 #endif // XNCP_TYPES_H
@@ -5,20 +5,54 @@
  */
 
 #include "xncp_types.h"
+#include "xncp_buffer.h"
 #include "xncp_dispatcher.h"
+#include "xncp_perf.h"
+
+#include <string.h>
 
 #define BUILD_UINT16(low, high) (((uint16_t)(low)) | ((uint16_t)(high) << 8))
 
+// Sub-command reply length marking a result that no longer fit into the reply
+#define XNCP_MULTI_COMMAND_REPLY_DROPPED 0xFF
+
+// Runs a single command, shared by top-level frames and multi-command sub-commands
+static void xncp_execute_command(xncp_context_t *ctx)
+{
+    XNCP_PERF_START(start);
+
+    uint8_t reply_start = *ctx->reply_length;
+
+    // Handle get_supported_features internally
+    if (ctx->command_id == XNCP_CMD_GET_SUPPORTED_FEATURES_REQ) {
+        *ctx->response_id = XNCP_CMD_GET_SUPPORTED_FEATURES_REQ | XNCP_CMD_RESPONSE_BIT;
+        xncp_reply_put_u32(ctx, xncp_get_supported_features());
+    } else if (!xncp_dispatch_command(ctx)) {
+        // No registered handler
+        *ctx->status = XNCP_STATUS_NOT_FOUND;
+    }
+
+    // Never send a truncated reply
+    if (ctx->reply_overflow) {
+        *ctx->reply_length = reply_start;
+        *ctx->status = XNCP_STATUS_OVERFLOW;
+    }
+
+    XNCP_PERF_RECORD_COMMAND(ctx->command_id, start);
+}
+
 static xncp_status_t xncp_incoming_custom_frame_handler(
     uint8_t messageLength,
     uint8_t *messagePayload,
     uint8_t *replyPayloadLength,
     uint8_t *replyPayload)
 {
+    XNCP_PERF_START(start);
+
     uint8_t rsp_status = XNCP_STATUS_OK;
     uint16_t rsp_command_id = XNCP_CMD_UNKNOWN;
 
-    if (messageLength < 3) {
+    if (messageLength < XNCP_HEADER_LENGTH) {
         rsp_status = XNCP_STATUS_BAD_ARGUMENT;
         goto respond;
     }
@@ -27,45 +61,113 @@ static xncp_status_t xncp_incoming_custom_frame_handler(
     // uint8_t req_status = messagePayload[2];  // Unused
 
     // Strip the packet header to simplify command parsing
-    messagePayload += 3;
-    messageLength -= 3;
+    messagePayload += XNCP_HEADER_LENGTH;
+    messageLength -= XNCP_HEADER_LENGTH;
 
     // Leave space for the reply packet header
-    *replyPayloadLength = 3;
-
-    // Handle get_supported_features internally
-    if (req_command_id == XNCP_CMD_GET_SUPPORTED_FEATURES_REQ) {
-        uint32_t features = xncp_get_supported_features();
-        rsp_command_id = XNCP_CMD_GET_SUPPORTED_FEATURES_REQ | XNCP_CMD_RESPONSE_BIT;
-        replyPayload[(*replyPayloadLength)++] = (uint8_t)((features >>  0) & 0xFF);
-        replyPayload[(*replyPayloadLength)++] = (uint8_t)((features >>  8) & 0xFF);
-        replyPayload[(*replyPayloadLength)++] = (uint8_t)((features >> 16) & 0xFF);
-        replyPayload[(*replyPayloadLength)++] = (uint8_t)((features >> 24) & 0xFF);
-        goto respond;
-    }
+    *replyPayloadLength = XNCP_HEADER_LENGTH;
 
-    // Try dispatching to registered handlers
     xncp_context_t ctx = {
         .command_id = req_command_id,
         .payload = messagePayload,
         .payload_length = messageLength,
         .reply = replyPayload,
         .reply_length = replyPayloadLength,
+        .reply_capacity = XNCP_MAX_REPLY_LENGTH,
         .status = &rsp_status,
         .response_id = &rsp_command_id
     };
 
-    if (!xncp_dispatch_command(&ctx)) {
-        rsp_status = XNCP_STATUS_NOT_FOUND;
-    }
+    xncp_execute_command(&ctx);
 
 respond:
     replyPayload[0] = (uint8_t)((rsp_command_id >> 0) & 0xFF);
     replyPayload[1] = (uint8_t)((rsp_command_id >> 8) & 0xFF);
     replyPayload[2] = rsp_status;
+
+    XNCP_PERF_RECORD_FRAME(start);
     return XNCP_STATUS_OK;
 }
 
+//------------------------------------------------------------------------------
+// Multi-command (XNCP_FEATURE_MULTI_COMMAND)
+//------------------------------------------------------------------------------
+
+// Request:  [command_id(2) length(1) payload(length)]*
+// Response: count(1) [status(1) length(1) reply(length)]*
+//
+// Sub-commands run in order until the reply buffer is exhausted, `count` tells the
+// host how many of them were executed. A sub-command whose reply did not fit still
+// ran: its status is reported but its length is XNCP_MULTI_COMMAND_REPLY_DROPPED.
+bool xncp_handle_multi_command(xncp_context_t *ctx)
+{
+    // Validate the framing up front so a malformed batch has no side effects
+    for (uint8_t offset = 0; offset < ctx->payload_length;) {
+        if ((ctx->payload_length - offset) < 3) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+
+        uint16_t command_id = BUILD_UINT16(ctx->payload[offset], ctx->payload[offset + 1]);
+        uint8_t length = ctx->payload[offset + 2];
+
+        if ((command_id == XNCP_CMD_MULTI_COMMAND_REQ)
+            || ((ctx->payload_length - offset - 3) < length)) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+
+        offset += 3 + length;
+    }
+
+    uint8_t *count = xncp_reply_reserve(ctx, 1);
+    if (count == NULL) {
+        return true;
+    }
+
+    *count = 0;
+
+    for (uint8_t offset = 0; offset < ctx->payload_length;) {
+        // Every result needs at least its status and length
+        if (xncp_reply_remaining(ctx) < 2) {
+            break;
+        }
+
+        uint8_t sub_reply[XNCP_MAX_REPLY_LENGTH - XNCP_HEADER_LENGTH];
+        uint8_t sub_reply_length = 0;
+        uint8_t sub_status = XNCP_STATUS_OK;
+        uint16_t sub_response_id = XNCP_CMD_UNKNOWN;
+
+        xncp_context_t sub_ctx = {
+            .command_id = BUILD_UINT16(ctx->payload[offset], ctx->payload[offset + 1]),
+            .payload = &ctx->payload[offset + 3],
+            .payload_length = ctx->payload[offset + 2],
+            .reply = sub_reply,
+            .reply_length = &sub_reply_length,
+            .reply_capacity = sizeof(sub_reply),
+            .status = &sub_status,
+            .response_id = &sub_response_id
+        };
+
+        offset += 3 + sub_ctx.payload_length;
+        xncp_execute_command(&sub_ctx);
+        (*count)++;
+
+        xncp_reply_put_u8(ctx, sub_status);
+
+        if ((xncp_reply_remaining(ctx) - 1) < sub_reply_length) {
+            xncp_reply_put_u8(ctx, XNCP_MULTI_COMMAND_REPLY_DROPPED);
+            break;
+        }
+
+        xncp_reply_put_u8(ctx, sub_reply_length);
+        xncp_reply_put_bytes(ctx, sub_reply, sub_reply_length);
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
 #ifdef STACK_TYPES_HEADER
 sl_status_t sl_zigbee_af_xncp_incoming_custom_frame_cb(
     uint8_t messageLength,
@@ -0,0 +1,245 @@
+/*
+ * xncp_notify.c
+ *
+ * XNCP notifications (XNCP_FEATURE_NOTIFICATIONS)
+ *
+ * Notifications wait in a small priority queue and are sent from the main loop, one
+ * per pass, so a burst of events cannot starve the stack or flood the EZSP callback
+ * queue. A notification the stack could not send stays queued and is retried.
+ */
+
+#include "xncp_notify.h"
+#include "xncp.h"
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+#ifdef STACK_TYPES_HEADER
+#define xncp_send_custom_frame sl_zigbee_af_xncp_send_custom_ezsp_message
+#else
+#define xncp_send_custom_frame emberAfPluginXncpSendCustomEzspMessage
+#endif
+
+#define BUILD_UINT16(low, high) (((uint16_t)(low)) | ((uint16_t)(high) << 8))
+
+// event_type(1) + min_interval_ms(2)
+#define SUBSCRIPTION_ENTRY_SIZE 3
+
+typedef struct {
+    uint32_t order;
+    uint8_t event_type;
+    uint8_t priority;
+    uint8_t length;
+    uint8_t payload[XNCP_NOTIFY_MAX_PAYLOAD_LENGTH];
+} PendingNotification;
+
+static PendingNotification queue[XNCP_NOTIFY_QUEUE_SIZE];
+static uint8_t queue_count;
+static uint32_t next_order;
+
+static uint32_t subscribed_mask;
+static uint16_t min_interval_ms[XNCP_NOTIFY_MAX_EVENT_TYPES];
+
+// Event types in `sent_mask` have been sent at least once, at `last_sent_ms`
+static uint32_t sent_mask;
+static uint32_t last_sent_ms[XNCP_NOTIFY_MAX_EVENT_TYPES];
+
+// Notifications dropped since the last one was sent, saturating
+static uint8_t dropped_count;
+
+static uint32_t now_ms(void)
+{
+    uint64_t ms = 0;
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+    return (uint32_t)ms;
+}
+
+static void count_dropped(void)
+{
+    if (dropped_count < UINT8_MAX) {
+        dropped_count++;
+    }
+}
+
+static void remove_entry(uint8_t index)
+{
+    // Queue order is kept in `order`, so the last entry can fill the hole
+    queue[index] = queue[--queue_count];
+}
+
+// Returns the index of the entry to evict: the oldest of the lowest priority
+static uint8_t find_eviction_candidate(void)
+{
+    uint8_t candidate = 0;
+
+    for (uint8_t i = 1; i < queue_count; i++) {
+        if ((queue[i].priority < queue[candidate].priority)
+            || ((queue[i].priority == queue[candidate].priority)
+                && ((int32_t)(queue[i].order - queue[candidate].order) < 0))) {
+            candidate = i;
+        }
+    }
+
+    return candidate;
+}
+
+static bool is_rate_limited(uint8_t event_type, uint32_t now)
+{
+    return (sent_mask & (1UL << event_type))
+           && ((now - last_sent_ms[event_type]) < min_interval_ms[event_type]);
+}
+
+bool xncp_notify_is_subscribed(uint8_t event_type)
+{
+    return (event_type < XNCP_NOTIFY_MAX_EVENT_TYPES)
+           && (subscribed_mask & (1UL << event_type));
+}
+
+uint16_t xncp_notify_get_min_interval(uint8_t event_type)
+{
+    if (!xncp_notify_is_subscribed(event_type)) {
+        return 0;
+    }
+
+    return min_interval_ms[event_type];
+}
+
+bool xncp_notify(uint8_t event_type,
+                 xncp_notify_priority_t priority,
+                 const uint8_t *payload,
+                 uint8_t length)
+{
+    if (!xncp_notify_is_subscribed(event_type) || (length > XNCP_NOTIFY_MAX_PAYLOAD_LENGTH)) {
+        return false;
+    }
+
+    PendingNotification *entry = NULL;
+
+    if (min_interval_ms[event_type] != 0) {
+        for (uint8_t i = 0; i < queue_count; i++) {
+            if (queue[i].event_type == event_type) {
+                entry = &queue[i];
+
+                if (priority > entry->priority) {
+                    entry->priority = priority;
+                }
+
+                break;
+            }
+        }
+    }
+
+    if (entry == NULL) {
+        if (queue_count < XNCP_NOTIFY_QUEUE_SIZE) {
+            entry = &queue[queue_count++];
+        } else {
+            uint8_t candidate = find_eviction_candidate();
+
+            if (queue[candidate].priority >= priority) {
+                count_dropped();
+                return false;
+            }
+
+            entry = &queue[candidate];
+            count_dropped();
+        }
+
+        entry->order = next_order++;
+        entry->event_type = event_type;
+        entry->priority = priority;
+    }
+
+    entry->length = length;
+    memcpy(entry->payload, payload, length);
+    return true;
+}
+
+void xncp_notify_process_action(void)
+{
+    if (queue_count == 0) {
+        return;
+    }
+
+    uint32_t now = now_ms();
+    int16_t next = -1;
+
+    // Highest priority first, oldest first within a priority
+    for (uint8_t i = 0; i < queue_count; i++) {
+        if (is_rate_limited(queue[i].event_type, now)) {
+            continue;
+        }
+
+        if ((next < 0)
+            || (queue[i].priority > queue[next].priority)
+            || ((queue[i].priority == queue[next].priority)
+                && ((int32_t)(queue[i].order - queue[next].order) < 0))) {
+            next = i;
+        }
+    }
+
+    if (next < 0) {
+        return;
+    }
+
+    PendingNotification *entry = &queue[next];
+    uint16_t notification_id = XNCP_CMD_NOTIFICATION_BIT | entry->event_type;
+
+    // Frame: notification_id(2) status(1) dropped(1) payload(length)
+    uint8_t frame[XNCP_HEADER_LENGTH + 1 + XNCP_NOTIFY_MAX_PAYLOAD_LENGTH];
+    uint8_t frame_length = 0;
+
+    frame[frame_length++] = (uint8_t)((notification_id >> 0) & 0xFF);
+    frame[frame_length++] = (uint8_t)((notification_id >> 8) & 0xFF);
+    frame[frame_length++] = XNCP_STATUS_OK;
+    frame[frame_length++] = dropped_count;
+    memcpy(frame + frame_length, entry->payload, entry->length);
+    frame_length += entry->length;
+
+    if (xncp_send_custom_frame(frame_length, frame) != XNCP_STATUS_OK) {
+        // The EZSP callback queue is full, try again on the next pass
+        return;
+    }
+
+    sent_mask |= (1UL << entry->event_type);
+    last_sent_ms[entry->event_type] = now;
+    dropped_count = 0;
+    remove_entry((uint8_t)next);
+}
+
+// Request: [event_type(1) min_interval_ms(2)]*
+//
+// Replaces the subscriptions, an empty request unsubscribes from everything. At most
+// one notification of an event type is sent every `min_interval_ms`, events in between
+// are coalesced into it.
+bool xncp_handle_set_notifications(xncp_context_t *ctx)
+{
+    if ((ctx->payload_length % SUBSCRIPTION_ENTRY_SIZE) != 0) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    for (uint8_t offset = 0; offset < ctx->payload_length; offset += SUBSCRIPTION_ENTRY_SIZE) {
+        if (ctx->payload[offset] >= XNCP_NOTIFY_MAX_EVENT_TYPES) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+    }
+
+    subscribed_mask = 0;
+
+    for (uint8_t offset = 0; offset < ctx->payload_length; offset += SUBSCRIPTION_ENTRY_SIZE) {
+        uint8_t event_type = ctx->payload[offset];
+
+        subscribed_mask |= (1UL << event_type);
+        min_interval_ms[event_type] = BUILD_UINT16(ctx->payload[offset + 1], ctx->payload[offset + 2]);
+    }
+
+    // Drop whatever the host is no longer interested in
+    for (uint8_t i = queue_count; i > 0; i--) {
+        if (!(subscribed_mask & (1UL << queue[i - 1].event_type))) {
+            remove_entry(i - 1);
+        }
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
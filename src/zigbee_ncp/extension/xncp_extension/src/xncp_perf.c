@@ -0,0 +1,189 @@
+/*
+ * xncp_perf.c
+ *
+ * XNCP performance counters (XNCP_FEATURE_PERF_COUNTERS)
+ *
+ * Handler latency is measured in core clock cycles with the DWT cycle counter, which
+ * is enabled the first time it is needed. Per-command totals include everything the
+ * handler does, so a multi-command frame also accounts for its sub-commands.
+ */
+
+#include "xncp_perf.h"
+#include "xncp_buffer.h"
+
+#if XNCP_PERF_COUNTERS_ENABLED
+
+#include "em_device.h"
+#include <string.h>
+
+#define XNCP_PERF_FLAG_RESET (1 << 0)
+
+// Frames faster than 2^7 cycles all land in the first bucket
+#define HISTOGRAM_SHIFT 6
+
+// command_id(2) + count(4) + total_cycles(8) + max_cycles(4)
+#define COMMAND_ENTRY_SIZE 18
+
+typedef struct {
+    uint16_t command_id;
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} CommandCounters;
+
+static CommandCounters commands[XNCP_PERF_MAX_COMMANDS];
+static uint8_t command_count;
+
+static uint32_t frame_count;
+static uint32_t frame_max_cycles;
+static uint64_t frame_total_cycles;
+static uint16_t frame_histogram[XNCP_PERF_HISTOGRAM_BUCKETS];
+
+uint32_t xncp_perf_start(void)
+{
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+#if defined(DCB)
+        DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+#else
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#endif
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    return DWT->CYCCNT;
+}
+
+static uint8_t histogram_bucket(uint32_t cycles)
+{
+    // Index of the highest set bit, counting from 1
+    uint8_t bits = (uint8_t)(32 - __builtin_clz(cycles | 1));
+
+    if (bits <= HISTOGRAM_SHIFT + 1) {
+        return 0;
+    }
+
+    uint8_t bucket = bits - (HISTOGRAM_SHIFT + 1);
+    return (bucket < XNCP_PERF_HISTOGRAM_BUCKETS) ? bucket : (XNCP_PERF_HISTOGRAM_BUCKETS - 1);
+}
+
+void xncp_perf_record_command(uint16_t command_id, uint32_t start)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+    uint8_t index = 0;
+
+    while ((index < command_count) && (commands[index].command_id != command_id)) {
+        index++;
+    }
+
+    if (index == command_count) {
+        if (command_count == XNCP_PERF_MAX_COMMANDS) {
+            return;
+        }
+
+        command_count++;
+        commands[index].command_id = command_id;
+    }
+
+    CommandCounters *counters = &commands[index];
+    counters->count++;
+    counters->total_cycles += cycles;
+
+    if (cycles > counters->max_cycles) {
+        counters->max_cycles = cycles;
+    }
+}
+
+void xncp_perf_record_frame(uint32_t start)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    frame_count++;
+    frame_total_cycles += cycles;
+
+    if (cycles > frame_max_cycles) {
+        frame_max_cycles = cycles;
+    }
+
+    uint16_t *bucket = &frame_histogram[histogram_bucket(cycles)];
+    if (*bucket != UINT16_MAX) {
+        (*bucket)++;
+    }
+}
+
+static void xncp_perf_reset(void)
+{
+    memset(commands, 0, sizeof(commands));
+    command_count = 0;
+
+    frame_count = 0;
+    frame_max_cycles = 0;
+    frame_total_cycles = 0;
+    memset(frame_histogram, 0, sizeof(frame_histogram));
+}
+
+static void append_uint64(xncp_context_t *ctx, uint64_t value)
+{
+    xncp_reply_put_u32(ctx, (uint32_t)(value >>  0));
+    xncp_reply_put_u32(ctx, (uint32_t)(value >> 32));
+}
+
+// Request:  flags(1) start_index(1)
+// Response: core_clock_hz(4) frames(4) frame_total_cycles(8) frame_max_cycles(4)
+//           histogram(2 * XNCP_PERF_HISTOGRAM_BUCKETS) command_count(1) next_index(1)
+//           [command_id(2) count(4) total_cycles(8) max_cycles(4)]*
+//
+// Commands are paged: the host repeats the request with `start_index = next_index`
+// until `next_index == command_count`. With XNCP_PERF_FLAG_RESET set, all counters
+// are cleared after the reply has been built, so set it only on the last page.
+bool xncp_handle_get_perf_counters(xncp_context_t *ctx)
+{
+    if (ctx->payload_length != 2) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    uint8_t flags = ctx->payload[0];
+    uint8_t index = ctx->payload[1];
+
+    if (index > command_count) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    xncp_reply_put_u32(ctx, SystemCoreClockGet());
+    xncp_reply_put_u32(ctx, frame_count);
+    append_uint64(ctx, frame_total_cycles);
+    xncp_reply_put_u32(ctx, frame_max_cycles);
+
+    for (uint8_t i = 0; i < XNCP_PERF_HISTOGRAM_BUCKETS; i++) {
+        xncp_reply_put_u16(ctx, frame_histogram[i]);
+    }
+
+    xncp_reply_put_u8(ctx, command_count);
+    uint8_t *next_index = xncp_reply_reserve(ctx, 1);
+
+    if (next_index == NULL) {
+        return true;
+    }
+
+    while ((index < command_count) && (xncp_reply_remaining(ctx) >= COMMAND_ENTRY_SIZE)) {
+        const CommandCounters *counters = &commands[index++];
+
+        xncp_reply_put_u16(ctx, counters->command_id);
+        xncp_reply_put_u32(ctx, counters->count);
+        append_uint64(ctx, counters->total_cycles);
+        xncp_reply_put_u32(ctx, counters->max_cycles);
+    }
+
+    *next_index = index;
+
+    if (flags & XNCP_PERF_FLAG_RESET) {
+        xncp_perf_reset();
+    }
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+#endif // XNCP_PERF_COUNTERS_ENABLED
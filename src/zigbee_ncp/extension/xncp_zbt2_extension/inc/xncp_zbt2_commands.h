@@ -9,6 +9,28 @@
 
 #include "xncp_types.h"
 
-extern const xncp_command_def_t xncp_zbt2_commands[];
+// Command IDs (registered in xncp_zbt2_commands.slcc)
+#define XNCP_CMD_SET_LED_STATE_REQ      0x0F00
+#define XNCP_CMD_GET_ACCELEROMETER_REQ  0x0F01
+#define XNCP_CMD_SET_LED_PIXELS_REQ     0x0F02
+#define XNCP_CMD_SET_LED_ANIMATION_REQ  0x0F03
+
+// set_led_animation flags
+#define XNCP_LED_ANIMATION_FLAG_PLAY    (1 << 0)
+
+// op(1) arg(1) duration_ms(2) red(2) green(2) blue(2)
+#define XNCP_LED_KEYFRAME_SIZE          10
+
+// Notification event types (XNCP_FEATURE_NOTIFICATIONS)
+#define XNCP_EVENT_TILT_CHANGED         0x10
+#define XNCP_EVENT_ACCELEROMETER        0x11
+
+bool xncp_handle_set_led_state(xncp_context_t *ctx);
+bool xncp_handle_get_accelerometer(xncp_context_t *ctx);
+bool xncp_handle_set_led_pixels(xncp_context_t *ctx);
+bool xncp_handle_set_led_animation(xncp_context_t *ctx);
+
+// Main loop process action, turns tilt and accelerometer changes into notifications
+void xncp_zbt2_process_action(void);
 
 #endif // XNCP_ZBT2_COMMANDS_H
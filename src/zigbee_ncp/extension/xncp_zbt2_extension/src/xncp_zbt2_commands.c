@@ -6,43 +6,87 @@
 
 #include "xncp_zbt2_commands.h"
 #include "xncp_types.h"
+#include "xncp_buffer.h"
+#include "xncp_notify.h"
 #include "ws2812.h"
 #include "qma6100p.h"
 #include "led_effects.h"
 #include "led_manager.h"
 #include "sl_i2cspm_instances.h"
 #include "sl_simple_rgb_pwm_led.h"
+#include "sl_sleeptimer.h"
 #include <string.h>
 
-//------------------------------------------------------------------------------
-// Forward declarations
-//------------------------------------------------------------------------------
+// Floor for the accelerometer sampling interval, the I2C read is not free
+#define ACCELEROMETER_MIN_SAMPLE_INTERVAL_MS 100
+
+static bool reported_tilted;
+static uint32_t last_accelerometer_sample_ms;
+
+// Keyframes uploaded by the host, played on the manual layer
+static led_keyframe_t uploaded_animation[LED_ANIMATION_MAX_STEPS];
 
-static bool handle_set_led_state(xncp_context_t *ctx);
-static bool handle_get_accelerometer(xncp_context_t *ctx);
+// x(4) y(4) z(4)
+#define ACCELERATION_SIZE (3 * sizeof(float))
+
+static void read_acceleration(uint8_t buffer[ACCELERATION_SIZE])
+{
+    float xyz[3];
+    qma6100p_read_acc_xyz(sl_i2cspm_inst, xyz);
+
+    memcpy(buffer, (uint8_t*)xyz, sizeof(xyz));
+}
 
 //------------------------------------------------------------------------------
-// Command table
+// Notifications (XNCP_FEATURE_NOTIFICATIONS)
 //------------------------------------------------------------------------------
 
-const xncp_command_def_t xncp_zbt2_commands[] = {
-    {0x0F00, handle_set_led_state},
-    {0x0F01, handle_get_accelerometer},
-    {0, NULL}  // sentinel
-};
+// Event XNCP_EVENT_TILT_CHANGED:  tilted(1)
+// Event XNCP_EVENT_ACCELEROMETER: x(4) y(4) z(4)
+void xncp_zbt2_process_action(void)
+{
+    bool tilted = led_effects_is_tilted();
+
+    if (tilted != reported_tilted) {
+        uint8_t event = tilted;
+
+        reported_tilted = tilted;
+        xncp_notify(XNCP_EVENT_TILT_CHANGED, XNCP_NOTIFY_PRIORITY_HIGH, &event, sizeof(event));
+    }
+
+    if (xncp_notify_is_subscribed(XNCP_EVENT_ACCELEROMETER)) {
+        uint32_t interval_ms = xncp_notify_get_min_interval(XNCP_EVENT_ACCELEROMETER);
+        uint64_t now_ms = 0;
+
+        if (interval_ms < ACCELEROMETER_MIN_SAMPLE_INTERVAL_MS) {
+            interval_ms = ACCELEROMETER_MIN_SAMPLE_INTERVAL_MS;
+        }
+
+        sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &now_ms);
+
+        if (((uint32_t)now_ms - last_accelerometer_sample_ms) >= interval_ms) {
+            uint8_t event[ACCELERATION_SIZE];
+
+            last_accelerometer_sample_ms = (uint32_t)now_ms;
+            read_acceleration(event);
+            xncp_notify(XNCP_EVENT_ACCELEROMETER, XNCP_NOTIFY_PRIORITY_LOW, event, sizeof(event));
+        }
+    }
+}
 
 //------------------------------------------------------------------------------
 // Handlers
 //------------------------------------------------------------------------------
 
-static bool handle_set_led_state(xncp_context_t *ctx)
+bool xncp_handle_set_led_state(xncp_context_t *ctx)
 {
     rgb_t color;
 
     if (ctx->payload_length == 3) {
-        color.r = (uint16_t)ctx->payload[0] << 8;
-        color.g = (uint16_t)ctx->payload[1] << 8;
-        color.b = (uint16_t)ctx->payload[2] << 8;
+        // Scaled like `RGB8`, so 8-bit colors are shown without dithering
+        color.r = (uint16_t)ctx->payload[0] * 257;
+        color.g = (uint16_t)ctx->payload[1] * 257;
+        color.b = (uint16_t)ctx->payload[2] * 257;
     } else if (ctx->payload_length == 6) {
         color.r = ((uint16_t)ctx->payload[0] << 8) | ctx->payload[1];
         color.g = ((uint16_t)ctx->payload[2] << 8) | ctx->payload[3];
@@ -58,22 +102,96 @@ static bool handle_set_led_state(xncp_context_t *ctx)
     return true;
 }
 
-static bool handle_get_accelerometer(xncp_context_t *ctx)
+// Request:  [first(1) [red(2) green(2) blue(2)]*]
+// Response: led_count(1)
+//
+// Sets individual LEDs on the manual layer, starting at index `first`. An empty
+// request only reports the number of LEDs.
+bool xncp_handle_set_led_pixels(xncp_context_t *ctx)
 {
-    float xyz[3];
-    qma6100p_read_acc_xyz(sl_i2cspm_inst, xyz);
+    rgb_t colors[WS2812_NUM_LEDS];
+    uint8_t count = 0;
+
+    if (ctx->payload_length > 0) {
+        xncp_reader_t reader = xncp_payload_reader(ctx);
+        uint8_t first = xncp_read_u8(&reader);
+
+        while (xncp_reader_has_more(&reader) && (count < WS2812_NUM_LEDS)) {
+            colors[count].r = xncp_read_u16(&reader);
+            colors[count].g = xncp_read_u16(&reader);
+            colors[count].b = xncp_read_u16(&reader);
+            count++;
+        }
+
+        if (!xncp_reader_done(&reader) || (count == 0)
+            || !led_manager_set_pixels(LED_PRIORITY_MANUAL, first, colors, count)) {
+            *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+            return true;
+        }
+    }
+
+    xncp_reply_put_u8(ctx, led_manager_get_pixel_count());
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+// Request:  flags(1) first(1)
+//           [op(1) arg(1) duration_ms(2) red(2) green(2) blue(2)]*
+// Response: max_steps(1)
+//
+// Stores keyframes from step `first` on, so animations that do not fit into one frame
+// can be uploaded in pieces. Uploading stops whatever the manual layer shows. With
+// the play flag, steps 0 to the last one written are played on the manual layer.
+bool xncp_handle_set_led_animation(xncp_context_t *ctx)
+{
+    xncp_reader_t reader = xncp_payload_reader(ctx);
+    uint8_t flags = xncp_read_u8(&reader);
+    uint8_t first = xncp_read_u8(&reader);
+    uint8_t count = 0;
+
+    if (!xncp_reader_ok(&reader)
+        || (((ctx->payload_length - 2) % XNCP_LED_KEYFRAME_SIZE) != 0)
+        || (first + ((ctx->payload_length - 2) / XNCP_LED_KEYFRAME_SIZE) > LED_ANIMATION_MAX_STEPS)) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    // The layer may be playing the buffer that is about to be overwritten
+    led_manager_clear_pattern(LED_PRIORITY_MANUAL);
 
-    // X
-    memcpy(ctx->reply + *ctx->reply_length, (uint8_t*)&xyz[0], sizeof(float));
-    *ctx->reply_length += sizeof(float);
+    while (xncp_reader_has_more(&reader)) {
+        led_keyframe_t *step = &uploaded_animation[first + count];
 
-    // Y
-    memcpy(ctx->reply + *ctx->reply_length, (uint8_t*)&xyz[1], sizeof(float));
-    *ctx->reply_length += sizeof(float);
+        step->op = xncp_read_u8(&reader);
+        step->arg = xncp_read_u8(&reader);
+        step->duration_ms = xncp_read_u16(&reader);
+        step->color[0] = xncp_read_u16(&reader);
+        step->color[1] = xncp_read_u16(&reader);
+        step->color[2] = xncp_read_u16(&reader);
+        count++;
+    }
 
-    // Z
-    memcpy(ctx->reply + *ctx->reply_length, (uint8_t*)&xyz[2], sizeof(float));
-    *ctx->reply_length += sizeof(float);
+    if ((flags & XNCP_LED_ANIMATION_FLAG_PLAY)
+        && !led_manager_play_animation(LED_PRIORITY_MANUAL, uploaded_animation, first + count, NULL)) {
+        *ctx->status = XNCP_STATUS_BAD_ARGUMENT;
+        return true;
+    }
+
+    xncp_reply_put_u8(ctx, LED_ANIMATION_MAX_STEPS);
+
+    *ctx->status = XNCP_STATUS_OK;
+    return true;
+}
+
+bool xncp_handle_get_accelerometer(xncp_context_t *ctx)
+{
+    uint8_t *xyz = xncp_reply_reserve(ctx, ACCELERATION_SIZE);
+
+    if (xyz != NULL) {
+        // X, Y, Z
+        read_acceleration(xyz);
+    }
 
     *ctx->status = XNCP_STATUS_OK;
     return true;
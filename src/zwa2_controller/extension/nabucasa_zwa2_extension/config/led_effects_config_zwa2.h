@@ -14,6 +14,14 @@
 #define LED_EFFECTS_UPDATE_INTERVAL_MS    4
 #endif
 
+// <o LED_EFFECTS_DITHER_INTERVAL_MS> LED dithering interval (ms)
+// <i> Frame interval for colors between two 8-bit levels. LEDs dither out of phase,
+// <i> so this can be slower than the update interval without visible flicker.
+// <d> 8
+#ifndef LED_EFFECTS_DITHER_INTERVAL_MS
+#define LED_EFFECTS_DITHER_INTERVAL_MS    8
+#endif
+
 // <o LED_EFFECTS_TILT_THRESHOLD_UPPER> Tilt entry threshold (degrees)
 // <i> Angle from vertical to enter tilted state
 // <d> 16
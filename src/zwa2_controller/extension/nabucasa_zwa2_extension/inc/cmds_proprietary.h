@@ -18,8 +18,13 @@ typedef enum
   NABU_CASA_CONFIG_SET = 6,
   NABU_CASA_LED_GET_BINARY = 7,
   NABU_CASA_LED_SET_BINARY = 8,
+  NABU_CASA_LED_SET_PIXELS = 9,
+  NABU_CASA_LED_SET_ANIMATION = 10,
 } eNabuCasaCmd;
 
+/* NABU_CASA_LED_SET_ANIMATION flags */
+#define NC_LED_ANIMATION_FLAG_PLAY 0x01
+
 typedef enum
 {
   NC_SYS_INDICATION_OFF = 0,
@@ -15,6 +15,7 @@
 #include "led_manager_zwa2.h"
 #include "led_manager_colors_zwa2.h"
 #include "led_effects_zwa2.h"
+#include "ws2812.h"
 
 #define BYTE_INDEX(x) (x / 8)
 #define BYTE_OFFSET(x) (1 << (x % 8))
@@ -23,6 +24,12 @@
 /* Track whether the manual LED layer is "on" (for GET commands) */
 static bool manual_led_on = false;
 
+/* Keyframes uploaded with NABU_CASA_LED_SET_ANIMATION */
+static led_keyframe_t uploaded_animation[LED_ANIMATION_MAX_STEPS];
+
+/* op | arg | durationMSB | durationLSB | r | g | b */
+#define KEYFRAME_SIZE 7
+
 bool nc_config_get(eNabuCasaConfigKey key)
 {
   NabuCasaConfigStorage_t cfg = CONFIG_STORAGE_DEFAULTS;
@@ -84,12 +91,14 @@ ZW_ADD_CMD(FUNC_ID_NABU_CASA)
     BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_LED_SET);
     BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_LED_GET_BINARY);
     BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_LED_SET_BINARY);
+    BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_LED_SET_PIXELS);
+    BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_LED_SET_ANIMATION);
     BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_SYSTEM_INDICATION_SET);
     BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_CONFIG_GET);
     BITMASK_ADD_CMD(supportedBitmask, NABU_CASA_CONFIG_SET);
 
     // Copy as few bytes as necessary into the output buffer
-    for (int j = 0; j <= NABU_CASA_LED_SET_BINARY / 8; j++)
+    for (int j = 0; j <= NABU_CASA_LED_SET_ANIMATION / 8; j++)
     {
       response[i++] = supportedBitmask[j];
     }
@@ -184,6 +193,86 @@ ZW_ADD_CMD(FUNC_ID_NABU_CASA)
     break;
   }
 
+  case NABU_CASA_LED_SET_PIXELS:
+  {
+    // HOST->ZW: NABU_CASA_LED_SET_PIXELS | first | [r | g | b]*
+    // ZW->HOST: NABU_CASA_LED_SET_PIXELS | true | ledCount
+
+    // Sets individual LEDs on the manual layer. Unlike NABU_CASA_LED_SET, the
+    // colors are used as given and not stored in NVM.
+    uint8_t count = (inputLength >= 2) ? (inputLength - 2) / 3 : 0;
+
+    if (count > 0 && count <= WS2812_NUM_LEDS && inputLength == 2 + 3 * count)
+    {
+      rgb_t colors[WS2812_NUM_LEDS];
+      bool state = false;
+
+      for (int j = 0; j < count; j++)
+      {
+        const uint8_t *rgb = &pInputBuffer[2 + 3 * j];
+        colors[j] = RGB8(rgb[0], rgb[1], rgb[2]);
+        state |= (rgb[0] > 0 || rgb[1] > 0 || rgb[2] > 0);
+      }
+
+      if (led_manager_set_pixels(LED_PRIORITY_MANUAL, pInputBuffer[1], colors, count))
+      {
+        manual_led_on = state;
+        cmdRes = true;
+      }
+    }
+    response[i++] = cmdRes;
+    response[i++] = led_manager_get_pixel_count();
+    break;
+  }
+
+  case NABU_CASA_LED_SET_ANIMATION:
+  {
+    // HOST->ZW: NABU_CASA_LED_SET_ANIMATION | flags | first | [op | arg | durationMSB | durationLSB | r | g | b]*
+    // ZW->HOST: NABU_CASA_LED_SET_ANIMATION | true | maxSteps
+
+    // Stores keyframes from step `first` on, so long animations can be uploaded in
+    // pieces. Uploading stops whatever the manual layer shows. With the play flag,
+    // steps 0 to the last one written are played on the manual layer.
+    uint8_t count = (inputLength >= 3) ? (inputLength - 3) / KEYFRAME_SIZE : 0;
+
+    if (inputLength >= 3
+        && inputLength == 3 + KEYFRAME_SIZE * count
+        && pInputBuffer[2] + count <= LED_ANIMATION_MAX_STEPS)
+    {
+      uint8_t first = pInputBuffer[2];
+
+      // The layer may be playing the buffer that is about to be overwritten
+      led_manager_clear_pattern(LED_PRIORITY_MANUAL);
+      manual_led_on = false;
+
+      for (int j = 0; j < count; j++)
+      {
+        const uint8_t *frame = &pInputBuffer[3 + KEYFRAME_SIZE * j];
+        led_keyframe_t *step = &uploaded_animation[first + j];
+
+        step->op = frame[0];
+        step->arg = frame[1];
+        step->duration_ms = (frame[2] << 8) | frame[3];
+        step->color[0] = frame[4] * 257;
+        step->color[1] = frame[5] * 257;
+        step->color[2] = frame[6] * 257;
+      }
+
+      if (!(pInputBuffer[1] & NC_LED_ANIMATION_FLAG_PLAY))
+      {
+        cmdRes = true;
+      }
+      else if (led_manager_play_animation(LED_PRIORITY_MANUAL, uploaded_animation, first + count, NULL))
+      {
+        manual_led_on = true;
+        cmdRes = true;
+      }
+    }
+    response[i++] = cmdRes;
+    response[i++] = LED_ANIMATION_MAX_STEPS;
+    break;
+  }
+
   case NABU_CASA_SYSTEM_INDICATION_SET:
     // HOST->ZW (REQ): NABU_CASA_SYSTEM_INDICATION_SET | severity
     // ZW->HOST (RES): NABU_CASA_SYSTEM_INDICATION_SET | true
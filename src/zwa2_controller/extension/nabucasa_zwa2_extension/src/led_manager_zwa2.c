@@ -12,14 +12,39 @@ typedef struct {
     bool active;
     uint32_t start_tick;
     uint32_t expiry_tick;
+    rgb_t pixels[WS2812_NUM_LEDS];  // LED_MODE_PIXELS colors
+    led_envelope_t envelope;        // LED_MODE_PULSE brightness
+    led_animation_t animation;      // LED_MODE_ANIMATION position
+    led_animation_done_t on_done;
+    uint16_t animation_color[3];
 } led_layer_state_t;
 
+// Timer ticks between two frames sent to the LEDs
+#define LED_DITHER_TICKS \
+    ((LED_EFFECTS_DITHER_INTERVAL_MS > LED_EFFECTS_UPDATE_INTERVAL_MS) \
+     ? (LED_EFFECTS_DITHER_INTERVAL_MS / LED_EFFECTS_UPDATE_INTERVAL_MS) : 1)
+
 static led_layer_state_t layers[LED_PRIORITY_COUNT];
 static sl_sleeptimer_timer_handle_t led_timer;
 static volatile uint32_t global_tick_counter = 0;
 static volatile bool update_needed = false;
 static bool manager_initialized = false;
 
+// Done callbacks of animations that ended during the last update
+static led_animation_done_t finished_animations[LED_PRIORITY_COUNT];
+
+// Called after an update, the callbacks may set new patterns
+static void notify_finished_animations(void) {
+    for (int i = 0; i < LED_PRIORITY_COUNT; i++) {
+        led_animation_done_t on_done = finished_animations[i];
+
+        if (on_done != NULL) {
+            finished_animations[i] = NULL;
+            on_done((led_priority_t)i);
+        }
+    }
+}
+
 static void update_led_hardware(void) {
     int top_layer = -1;
     uint32_t current_tick = global_tick_counter;
@@ -32,6 +57,26 @@ static void update_led_hardware(void) {
                 layers[i].active = false;
                 continue;
             }
+
+            // Animations advance even while hidden, so they end on time
+            if (layers[i].pattern.mode == LED_MODE_ANIMATION) {
+                uint32_t animation_next_ms = 0;
+                led_animation_state_t state = led_animation_update(&layers[i].animation,
+                                                                   current_tick * LED_EFFECTS_UPDATE_INTERVAL_MS,
+                                                                   layers[i].animation_color,
+                                                                   &animation_next_ms);
+
+                if (state == LED_ANIMATION_DONE) {
+                    layers[i].active = false;
+                    finished_animations[i] = layers[i].on_done;
+                    continue;
+                }
+
+                if (state == LED_ANIMATION_TRANSPARENT) {
+                    continue;
+                }
+            }
+
             if (top_layer == -1) {
                 top_layer = i;
             }
@@ -59,6 +104,21 @@ static void update_led_hardware(void) {
             sl_led_turn_on(&sl_led_ws2812.led_common);
             break;
 
+        case LED_MODE_ANIMATION:
+            sl_led_set_rgb_color(&sl_led_ws2812,
+                                 l->animation_color[0],
+                                 l->animation_color[1],
+                                 l->animation_color[2]);
+            sl_led_turn_on(&sl_led_ws2812.led_common);
+            break;
+
+        case LED_MODE_PIXELS:
+            for (uint8_t i = 0; i < WS2812_NUM_LEDS; i++) {
+                ws2812_led_driver_set_pixel(i, l->pixels[i].r, l->pixels[i].g, l->pixels[i].b);
+            }
+            sl_led_turn_on(&sl_led_ws2812.led_common);
+            break;
+
         case LED_MODE_BLINK: {
             uint32_t period = (p->period_ms > 0) ? p->period_ms : 500;
             bool on = (ms_elapsed % period) < (period / 2);
@@ -72,26 +132,13 @@ static void update_led_hardware(void) {
         }
 
         case LED_MODE_PULSE: {
-            uint32_t period = (p->period_ms >= 2) ? p->period_ms : 1000;
-            uint32_t half_period = period / 2;
-            uint32_t phase = ms_elapsed % period;
+            // Envelope precomputed by led_manager_set_pattern()
+            uint16_t brightness = led_envelope_level(&l->envelope, ms_elapsed);
 
-            uint32_t brightness;
-            if (phase < half_period) {
-                brightness = (phase * 65535) / half_period;
-            } else {
-                brightness = 65535 - ((phase - half_period) * 65535) / (period - half_period);
-            }
-
-            uint32_t min_b = p->brightness_min;
-            uint32_t max_b = p->brightness_max;
-            brightness = min_b + ((max_b - min_b) * brightness / 65535);
-
-            uint16_t r = ((uint32_t)p->color.r * brightness) / 65535;
-            uint16_t g = ((uint32_t)p->color.g * brightness) / 65535;
-            uint16_t b = ((uint32_t)p->color.b * brightness) / 65535;
-
-            sl_led_set_rgb_color(&sl_led_ws2812, r, g, b);
+            sl_led_set_rgb_color(&sl_led_ws2812,
+                                 led_scale(p->color.r, brightness),
+                                 led_scale(p->color.g, brightness),
+                                 led_scale(p->color.b, brightness));
             sl_led_turn_on(&sl_led_ws2812.led_common);
             break;
         }
@@ -102,8 +149,14 @@ static void led_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
     (void)handle;
     (void)data;
     global_tick_counter++;
+    // The Z-Wave app runs on FreeRTOS without process actions, so frames are encoded
+    // here. This is the only caller of the driver, which it requires.
     update_led_hardware();
-    ws2812_led_driver_refresh();
+    // Frames go out at the dithering rate, unchanged ones are skipped by the driver
+    if ((global_tick_counter % LED_DITHER_TICKS) == 0) {
+        ws2812_led_driver_refresh();
+    }
+    notify_finished_animations();
 }
 
 void led_manager_init(void) {
@@ -130,10 +183,21 @@ void led_manager_process_action(void) {
 void led_manager_set_pattern(led_priority_t priority, const led_pattern_t *pattern) {
     if (priority >= LED_PRIORITY_COUNT) return;
 
+    // Computed up front, it is too slow for a critical section
+    led_envelope_t envelope;
+    if (pattern->mode == LED_MODE_PULSE) {
+        uint16_t period = (pattern->period_ms >= 2) ? pattern->period_ms : 1000;
+        led_envelope_init(&envelope, pattern->waveform, period,
+                          pattern->brightness_min, pattern->brightness_max);
+    }
+
     CORE_DECLARE_IRQ_STATE;
     CORE_ENTER_CRITICAL();
 
     layers[priority].pattern = *pattern;
+    if (pattern->mode == LED_MODE_PULSE) {
+        layers[priority].envelope = envelope;
+    }
     layers[priority].active = true;
     layers[priority].start_tick = global_tick_counter;
     
@@ -149,6 +213,57 @@ void led_manager_clear_pattern(led_priority_t priority) {
     layers[priority].active = false;
 }
 
+bool led_manager_play_animation(led_priority_t priority,
+                                const led_keyframe_t *steps,
+                                uint8_t step_count,
+                                led_animation_done_t on_done) {
+    if (priority >= LED_PRIORITY_COUNT) return false;
+    if (!led_animation_validate(steps, step_count)) return false;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+
+    led_layer_state_t *l = &layers[priority];
+
+    memset(&l->pattern, 0, sizeof(l->pattern));
+    l->pattern.mode = LED_MODE_ANIMATION;
+    l->active = true;
+    l->start_tick = global_tick_counter;
+    l->on_done = on_done;
+    led_animation_start(&l->animation, steps, step_count, l->start_tick * LED_EFFECTS_UPDATE_INTERVAL_MS);
+
+    CORE_EXIT_CRITICAL();
+    return true;
+}
+
+bool led_manager_set_pixels(led_priority_t priority, uint8_t first, const rgb_t *colors, uint8_t count) {
+    if (priority >= LED_PRIORITY_COUNT) return false;
+    if (first >= WS2812_NUM_LEDS || count > WS2812_NUM_LEDS - first) return false;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+
+    led_layer_state_t *l = &layers[priority];
+
+    // LEDs that are not set start out black
+    if (!l->active || l->pattern.mode != LED_MODE_PIXELS) {
+        memset(l->pixels, 0, sizeof(l->pixels));
+        memset(&l->pattern, 0, sizeof(l->pattern));
+        l->pattern.mode = LED_MODE_PIXELS;
+        l->active = true;
+        l->start_tick = global_tick_counter;
+    }
+
+    memcpy(&l->pixels[first], colors, count * sizeof(rgb_t));
+
+    CORE_EXIT_CRITICAL();
+    return true;
+}
+
+uint8_t led_manager_get_pixel_count(void) {
+    return WS2812_NUM_LEDS;
+}
+
 void led_manager_set_color(led_priority_t priority, rgb_t color) {
     led_pattern_t p = {
         .mode = LED_MODE_STATIC,
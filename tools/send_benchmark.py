@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""Tool to find the sustained APS unicast rate of an NCP built with the XNCP send
+benchmark (`XNCP_SEND_BENCHMARK_ENABLED`).
+
+The send rate is ramped up until the NCP fails to queue messages. Each step reports
+enqueue latency, APS queue and packet buffer heap usage, and why sends failed. This
+data is meant for tuning `SL_ZIGBEE_APS_UNICAST_MESSAGE_COUNT` and
+`SL_ZIGBEE_PACKET_BUFFER_HEAP_SIZE`.
+
+For a real NCP, pass `--device`. The NCP must already have formed a network that
+includes the destination. Use `--loopback tools/xncp_host/build/xncp_loopback` to run
+against the host build with a simulated radio instead.
+"""
+
+from __future__ import annotations
+
+import argparse
+import asyncio
+import dataclasses
+import logging
+import struct
+
+_LOGGER = logging.getLogger(__name__)
+
+XNCP_CMD_START_SEND_BENCHMARK = 0x001B
+XNCP_CMD_GET_SEND_BENCHMARK_RESULTS = 0x001C
+XNCP_CMD_RESPONSE_BIT = 0x8000
+XNCP_STATUS_OK = 0x00
+
+STATE_DONE = 3
+
+# destination(2) profile_id(2) cluster_id(2) endpoint(1) aps_options(2)
+# messages_per_s(2) count(2) payload_length(1)
+START_FORMAT = "<HHHBHHHB"
+
+POLL_INTERVAL = 0.1
+
+# Time the NCP gets to complete the last messages of a step
+DRAIN_TIMEOUT = 30.0
+
+
+@dataclasses.dataclass(frozen=True)
+class BenchmarkResults:
+    state: int
+    core_clock_hz: int
+    elapsed_ms: int
+    offered: int
+    queued: int
+    delivered: int
+    delivery_failed: int
+    queue_full: int
+    no_buffers: int
+    other_failures: int
+    last_other_status: int
+    latency_min_cycles: int
+    latency_avg_cycles: int
+    latency_max_cycles: int
+    max_in_flight: int
+    heap_start_bytes: int
+    heap_min_bytes: int
+
+    FORMAT = "<BIIHHHHHHHIIIIHHH"
+
+    @classmethod
+    def from_bytes(cls, data: bytes) -> BenchmarkResults:
+        return cls(*struct.unpack(cls.FORMAT, data))
+
+    @property
+    def queue_failures(self) -> int:
+        return self.queue_full + self.no_buffers + self.other_failures
+
+    @property
+    def sustained_rate(self) -> float:
+        return self.queued / max(self.elapsed_ms, 1) * 1000
+
+    def cycles_to_us(self, cycles: int) -> float:
+        return cycles / self.core_clock_hz * 1e6
+
+
+class LoopbackTransport:
+    """The host build of the XNCP core, exchanging hex encoded frames over pipes."""
+
+    def __init__(self, path: str, radio_rate: int) -> None:
+        self._path = path
+        self._radio_rate = radio_rate
+        self._process: asyncio.subprocess.Process | None = None
+
+    async def connect(self) -> None:
+        self._process = await asyncio.create_subprocess_exec(
+            self._path,
+            "-r",
+            str(self._radio_rate),
+            stdin=asyncio.subprocess.PIPE,
+            stdout=asyncio.subprocess.PIPE,
+        )
+
+    async def disconnect(self) -> None:
+        self._process.stdin.close()
+        await self._process.wait()
+
+    async def custom_frame(self, frame: bytes) -> bytes:
+        self._process.stdin.write(frame.hex().encode() + b"\n")
+        await self._process.stdin.drain()
+        line = (await self._process.stdout.readline()).decode().strip()
+
+        if not line or line.startswith("ERROR"):
+            raise RuntimeError(f"Loopback NCP rejected frame: {line!r}")
+
+        return bytes.fromhex(line)
+
+
+class EzspTransport:
+    """A real NCP, frames are sent with the EZSP `customFrame` command."""
+
+    def __init__(self, path: str, baudrate: int, flow_control: str | None) -> None:
+        self._config = {
+            "path": path,
+            "baudrate": baudrate,
+            "flow_control": flow_control,
+        }
+        self._ezsp = None
+
+    async def connect(self) -> None:
+        from bellows.ezsp import EZSP
+
+        self._ezsp = EZSP(self._config)
+        await self._ezsp.connect(use_thread=False)
+        await self._ezsp.startup_reset()
+
+    async def disconnect(self) -> None:
+        await self._ezsp.disconnect()
+
+    async def custom_frame(self, frame: bytes) -> bytes:
+        status, reply = await self._ezsp.customFrame(frame)
+
+        if status != XNCP_STATUS_OK:
+            raise RuntimeError(f"customFrame failed: {status!r}")
+
+        return reply
+
+
+async def send_command(transport, command_id: int, payload: bytes = b"") -> bytes:
+    reply = await transport.custom_frame(
+        struct.pack("<HB", command_id, XNCP_STATUS_OK) + payload
+    )
+    reply_id, status = struct.unpack("<HB", reply[:3])
+
+    if reply_id != (command_id | XNCP_CMD_RESPONSE_BIT) or status != XNCP_STATUS_OK:
+        raise RuntimeError(
+            f"Command 0x{command_id:04X} failed: id=0x{reply_id:04X} status=0x{status:02X}"
+        )
+
+    return reply[3:]
+
+
+async def run_step(transport, args: argparse.Namespace, rate: int) -> BenchmarkResults:
+    count = min(int(rate * args.duration), 0xFFFF)
+
+    await send_command(
+        transport,
+        XNCP_CMD_START_SEND_BENCHMARK,
+        struct.pack(
+            START_FORMAT,
+            args.destination,
+            args.profile,
+            args.cluster,
+            args.endpoint,
+            args.aps_options,
+            rate,
+            count,
+            args.payload_length,
+        ),
+    )
+
+    deadline = asyncio.get_running_loop().time() + args.duration + DRAIN_TIMEOUT
+
+    while True:
+        await asyncio.sleep(POLL_INTERVAL)
+        results = BenchmarkResults.from_bytes(
+            await send_command(transport, XNCP_CMD_GET_SEND_BENCHMARK_RESULTS)
+        )
+
+        if results.state == STATE_DONE:
+            return results
+
+        if asyncio.get_running_loop().time() > deadline:
+            _LOGGER.warning("Step at %d msg/s did not drain, stopping it", rate)
+            # A count of 0 stops the benchmark
+            await send_command(
+                transport,
+                XNCP_CMD_START_SEND_BENCHMARK,
+                bytes(struct.calcsize(START_FORMAT)),
+            )
+            return results
+
+
+def print_step(rate: int, results: BenchmarkResults) -> None:
+    print(
+        f"{rate:>7}  {results.offered:>7}  {results.queued:>7}"
+        f"  {results.queue_full:>5}  {results.no_buffers:>5}  {results.other_failures:>5}"
+        f"  {results.sustained_rate:>9.1f}"
+        f"  {results.cycles_to_us(results.latency_avg_cycles):>8.1f}"
+        f"  {results.cycles_to_us(results.latency_max_cycles):>8.1f}"
+        f"  {results.max_in_flight:>9}"
+        f"  {results.heap_start_bytes - results.heap_min_bytes:>9}"
+    )
+
+
+async def run(args: argparse.Namespace) -> int:
+    if args.loopback is not None:
+        transport = LoopbackTransport(args.loopback, args.loopback_radio_rate)
+    else:
+        transport = EzspTransport(args.device, args.baudrate, args.flow_control)
+
+    await transport.connect()
+
+    try:
+        print(
+            "   rate  offered   queued   full  nobuf  other  sustained  avg (us)"
+            "  max (us)  in flight  heap used"
+        )
+
+        rate = args.start_rate
+        last_passing_rate = None
+
+        while rate <= args.max_rate:
+            results = await run_step(transport, args, rate)
+            print_step(rate, results)
+
+            if results.other_failures:
+                _LOGGER.warning(
+                    "Last unexpected send status: 0x%08X", results.last_other_status
+                )
+
+            if results.queue_failures or results.state != STATE_DONE:
+                break
+
+            last_passing_rate = rate
+            rate = int(rate * args.step_factor) + 1
+        else:
+            print(f"\nNo queueing failures up to {args.max_rate} msg/s")
+            return 0
+
+        if last_passing_rate is None:
+            print(f"\nQueueing failed at the start rate of {rate} msg/s")
+        else:
+            print(
+                f"\nQueueing sustained at {last_passing_rate} msg/s,"
+                f" failed at {rate} msg/s"
+            )
+    finally:
+        await transport.disconnect()
+
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter,
+    )
+
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--device", help="Serial port of the NCP")
+    target.add_argument(
+        "--loopback", help="Path to the xncp_loopback host build of the XNCP core"
+    )
+
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument(
+        "--flow-control", choices=["software", "hardware"], default=None
+    )
+    parser.add_argument(
+        "--loopback-radio-rate",
+        type=int,
+        default=250,
+        help="Unicasts per second completed by the simulated radio",
+    )
+
+    parser.add_argument(
+        "--destination", type=lambda v: int(v, 0), default=0x0000, help="Node ID"
+    )
+    parser.add_argument("--profile", type=lambda v: int(v, 0), default=0x0104)
+    parser.add_argument("--cluster", type=lambda v: int(v, 0), default=0x0000)
+    parser.add_argument("--endpoint", type=int, default=1)
+    parser.add_argument(
+        "--aps-options",
+        type=lambda v: int(v, 0),
+        default=0x0140,
+        help="APS options, default is retry and route discovery",
+    )
+    parser.add_argument("--payload-length", type=int, default=16)
+
+    parser.add_argument("--start-rate", type=int, default=25, help="Messages/s")
+    parser.add_argument("--max-rate", type=int, default=2000, help="Messages/s")
+    parser.add_argument("--step-factor", type=float, default=1.25)
+    parser.add_argument(
+        "--duration", type=float, default=5.0, help="Seconds of sending per step"
+    )
+
+    args = parser.parse_args()
+    logging.basicConfig(level=logging.INFO)
+
+    raise SystemExit(asyncio.run(run(args)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,21 @@
+/*
+ * xncp_core_config.h
+ *
+ * Project copy of the XNCP core configuration for the host build. Options are turned
+ * on here, the way the configuration wizard edits a firmware project's config header,
+ * and not with compiler flags that the generated dispatcher would see but a firmware
+ * build would not.
+ */
+
+#ifndef HOST_XNCP_CORE_CONFIG_H
+#define HOST_XNCP_CORE_CONFIG_H
+
+#define XNCP_SEND_BENCHMARK_ENABLED 1
+#define XNCP_ROUTE_TABLE_JOURNAL_ENABLED 1
+#define XNCP_INCOMING_FILTER_ENABLED 1
+#define XNCP_NEIGHBOR_STATS_ENABLED 1
+#define XNCP_MEMORY_STATS_ENABLED 1
+
+#include_next "xncp_core_config.h"
+
+#endif // HOST_XNCP_CORE_CONFIG_H
@@ -0,0 +1,246 @@
+/*
+ * led_check.c
+ *
+ * Runs the ZBT-2 LED manager against a simulated clock, sleeptimer and LED, and checks
+ * what the LED shows over time. The manager is driven the way the main loop drives it:
+ * process actions are called, and time only moves on to the next timer deadline.
+ */
+
+#include "led_manager.h"
+#include "ws2812.h"
+#include "sl_sleeptimer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ORANGE_RED   65535
+#define ORANGE_GREEN 16448
+
+//------------------------------------------------------------------------------
+// Simulated platform
+//------------------------------------------------------------------------------
+
+static uint32_t now_ms;
+
+static sl_sleeptimer_timer_handle_t *armed_timer;
+static uint32_t timer_deadline_ms;
+
+static bool led_on;
+static uint16_t led_color[3];
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+    return now_ms;
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+    *ms = tick;
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_restart_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                           uint32_t timeout_ms,
+                                           sl_sleeptimer_timer_callback_t callback,
+                                           void *callback_data,
+                                           uint8_t priority,
+                                           uint16_t option_flags)
+{
+    handle->callback = callback;
+    handle->callback_data = callback_data;
+    armed_timer = handle;
+    timer_deadline_ms = now_ms + timeout_ms;
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+    if (armed_timer == handle) {
+        armed_timer = NULL;
+    }
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_led_init(const sl_led_t *led_handle)
+{
+    return SL_STATUS_OK;
+}
+
+void sl_led_turn_on(const sl_led_t *led_handle)
+{
+    led_on = true;
+}
+
+void sl_led_turn_off(const sl_led_t *led_handle)
+{
+    led_on = false;
+}
+
+void sl_led_set_rgb_color(const sl_led_rgb_pwm_t *led_handle, uint16_t red, uint16_t green, uint16_t blue)
+{
+    led_color[0] = red;
+    led_color[1] = green;
+    led_color[2] = blue;
+}
+
+void ws2812_led_driver_refresh(void)
+{
+}
+
+void ws2812_led_driver_set_pixel(uint8_t index, uint16_t red, uint16_t green, uint16_t blue)
+{
+}
+
+bool ws2812_led_driver_needs_dither(void)
+{
+    return false;
+}
+
+const sl_led_rgb_pwm_t sl_led_ws2812;
+
+//------------------------------------------------------------------------------
+// Checks
+//------------------------------------------------------------------------------
+
+static int failures;
+
+static uint32_t animation_done_ms;
+static bool animation_done;
+
+static void on_animation_done(led_priority_t priority)
+{
+    animation_done = true;
+    animation_done_ms = now_ms;
+}
+
+// Runs the main loop until `until_ms`, firing the timer whenever it is due
+static void run_until(uint32_t until_ms)
+{
+    while (true) {
+        led_manager_process_action();
+
+        if ((armed_timer == NULL) || (timer_deadline_ms > until_ms)) {
+            break;
+        }
+
+        sl_sleeptimer_timer_handle_t *timer = armed_timer;
+        armed_timer = NULL;
+        now_ms = timer_deadline_ms;
+        timer->callback(timer, timer->callback_data);
+    }
+
+    now_ms = until_ms;
+}
+
+static void expect_led(const char *name, uint32_t at_ms, bool on, uint16_t red, uint16_t green)
+{
+    run_until(at_ms);
+
+    bool ok = (led_on == on) && (!on || ((led_color[0] == red) && (led_color[1] == green)));
+
+    if (!ok) {
+        printf("FAIL %s: at %u ms the LED is %s %u/%u/%u\n", name, at_ms,
+               led_on ? "on" : "off", led_color[0], led_color[1], led_color[2]);
+        failures++;
+    }
+}
+
+static void expect_done(const char *name, uint32_t at_ms)
+{
+    run_until(at_ms + 100);
+
+    if (!animation_done || (animation_done_ms != at_ms)) {
+        printf("FAIL %s: animation %s\n", name, animation_done ? "ended early or late" : "never ended");
+        failures++;
+    }
+}
+
+static void reset(void)
+{
+    for (int i = 0; i < LED_PRIORITY_COUNT; i++) {
+        led_manager_clear_pattern((led_priority_t)i);
+    }
+
+    run_until(now_ms + 1000);
+    animation_done = false;
+}
+
+// Shaped like the reset button sequence: a delay, then a blink
+static const led_keyframe_t delayed_blink[] = {
+    { .op = LED_KEYFRAME_TRANSPARENT, .duration_ms = 700 },
+    { .op = LED_KEYFRAME_HOLD, .duration_ms = 150, .color = { ORANGE_RED, ORANGE_GREEN, 0 } },
+    { .op = LED_KEYFRAME_TRANSPARENT, .duration_ms = 50 },
+};
+
+// Nothing is active below the animation, so the LED is off while it is transparent
+static void check_transparent_without_layers_below(void)
+{
+    const char *name = "transparent animation alone";
+
+    reset();
+    uint32_t start = now_ms;
+    led_manager_play_animation(LED_PRIORITY_CRITICAL, delayed_blink, 3, on_animation_done);
+
+    expect_led(name, start + 10, false, 0, 0);
+    expect_led(name, start + 710, true, ORANGE_RED, ORANGE_GREEN);
+    expect_led(name, start + 860, false, 0, 0);
+    expect_done(name, start + 900);
+}
+
+static void check_transparent_over_static_layer(void)
+{
+    const char *name = "transparent animation over a static layer";
+
+    reset();
+    uint32_t start = now_ms;
+    led_manager_set_color(LED_PRIORITY_BACKGROUND, (rgb_t){ .r = 0, .g = 0, .b = 65535 });
+    led_manager_play_animation(LED_PRIORITY_CRITICAL, delayed_blink, 3, on_animation_done);
+
+    expect_led(name, start + 10, true, 0, 0);
+    expect_led(name, start + 710, true, ORANGE_RED, ORANGE_GREEN);
+    expect_led(name, start + 860, true, 0, 0);
+    expect_done(name, start + 900);
+}
+
+// A change made after the process action has run must keep the device awake
+static void check_pending_update_blocks_sleep(void)
+{
+    const char *name = "pending update blocks sleep";
+
+    reset();
+
+    if (!led_manager_is_ok_to_sleep()) {
+        printf("FAIL %s: no update pending but sleep is blocked\n", name);
+        failures++;
+    }
+
+    led_manager_set_color(LED_PRIORITY_MANUAL, (rgb_t){ .r = 65535, .g = 0, .b = 0 });
+
+    if (led_manager_is_ok_to_sleep()) {
+        printf("FAIL %s: sleep allowed with an update pending\n", name);
+        failures++;
+    }
+
+    expect_led(name, now_ms + 1, true, 65535, 0);
+
+    if (!led_manager_is_ok_to_sleep()) {
+        printf("FAIL %s: sleep still blocked after the update\n", name);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    led_manager_init();
+
+    check_transparent_without_layers_below();
+    check_transparent_over_static_layer();
+    check_pending_update_blocks_sleep();
+
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("LED manager checks passed\n");
+    return EXIT_SUCCESS;
+}
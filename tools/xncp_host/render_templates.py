@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Render the XNCP component templates from the `.slcc` template contributions.
+
+SLC normally renders these while generating the project. The host build has no SLC, so
+this collects the same contributions from every XNCP component and renders every
+component's templates with Jinja.
+"""
+
+from __future__ import annotations
+
+import argparse
+import collections
+import pathlib
+
+import jinja2
+from ruamel.yaml import YAML
+
+yaml = YAML(typ="safe")
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        "--extension-dir",
+        type=pathlib.Path,
+        required=True,
+        help="Directory containing the XNCP extensions",
+    )
+    parser.add_argument(
+        "--output-dir",
+        type=pathlib.Path,
+        required=True,
+        help="Directory to write the rendered files to",
+    )
+    args = parser.parse_args()
+
+    contributions: dict[str, list] = collections.defaultdict(list)
+
+    for slcc in sorted(args.extension_dir.glob("xncp_*/*.slcc")):
+        component = yaml.load(slcc.read_text())
+
+        for contribution in component.get("template_contribution", []):
+            contributions[contribution["name"]].append(contribution["value"])
+
+    args.output_dir.mkdir(parents=True, exist_ok=True)
+
+    for template_dir in sorted(args.extension_dir.glob("xncp_*/template")):
+        env = jinja2.Environment(loader=jinja2.FileSystemLoader(template_dir))
+
+        for template in sorted(template_dir.glob("*.jinja")):
+            output = args.output_dir / template.stem
+            output.write_text(env.get_template(template.name).render(**contributions))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,478 @@
+/*
+ * host_stack.c
+ *
+ * Minimal in-memory stand-in for the EmberZNet stack, used by the host build. Table
+ * lookups scan like the real stack does so that cache effects show up in benchmarks.
+ */
+
+#include "host_stack.h"
+#include "em_device.h"
+#include "sl_i2cspm_instances.h"
+#include "sl_sleeptimer.h"
+#include "led_manager.h"
+#include "buffer_manager/buffer-management.h"
+#include "stack/include/source-route.h"
+#include "xncp.h"
+
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint16_t destination;
+    sl_zigbee_aps_frame_t aps_frame;
+    uint16_t message_tag;
+    uint16_t buffer_bytes;
+} InFlightMessage;
+
+// Callbacks the stack would invoke, registered through template contributions
+void nc_zigbee_override_append_source_route(uint16_t destination, void *header, bool *consumed);
+void xncp_common_message_sent_cb(sl_status_t status,
+                                 sl_zigbee_outgoing_message_type_t type,
+                                 uint16_t indexOrDestination,
+                                 sl_zigbee_aps_frame_t *apsFrame,
+                                 uint16_t messageTag,
+                                 uint8_t messageLength,
+                                 uint8_t *message);
+void xncp_common_counter_cb(sl_zigbee_counter_type_t type, sl_zigbee_counter_info_t info);
+
+// Defined by the XNCP extensions, the firmware links them with `-Wl,--wrap`
+sl_status_t __wrap_sli_zigbee_stack_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                                 uint16_t index_or_destination,
+                                                 sl_zigbee_aps_frame_t *aps_frame,
+                                                 uint16_t message_tag,
+                                                 uint8_t message_length,
+                                                 const uint8_t *message_contents,
+                                                 uint8_t *aps_sequence);
+sl_status_t __wrap_sli_zigbee_stack_set_extended_timeout(sl_802154_long_addr_t remote_eui64,
+                                                         bool extended_timeout);
+sl_status_t __wrap_sli_zigbee_stack_set_address_table_info(uint8_t address_table_index,
+                                                           sl_802154_long_addr_t eui64,
+                                                           sl_802154_short_addr_t node_id);
+
+sli_zigbee_route_table_entry_t sli_zigbee_route_table[HOST_STACK_ROUTE_TABLE_SIZE];
+uint8_t sli_zigbee_route_table_size = HOST_STACK_ROUTE_TABLE_SIZE;
+uint8_t sli_zigbee_address_table_size = HOST_STACK_ADDRESS_TABLE_SIZE;
+uint8_t sli_zigbee_aps_unicast_message_count = HOST_STACK_APS_UNICAST_MESSAGE_COUNT;
+uint8_t sli_zigbee_broadcast_table_size = HOST_STACK_BROADCAST_TABLE_SIZE;
+
+static sl_802154_short_addr_t address_table_node_ids[HOST_STACK_ADDRESS_TABLE_SIZE];
+static sl_802154_long_addr_t address_table_eui64s[HOST_STACK_ADDRESS_TABLE_SIZE];
+static bool address_table_extended_timeouts[HOST_STACK_ADDRESS_TABLE_SIZE];
+
+static InFlightMessage in_flight[HOST_STACK_APS_UNICAST_MESSAGE_COUNT];
+static uint8_t in_flight_count;
+static uint8_t next_aps_sequence;
+
+static uint16_t packet_buffer_heap_size = HOST_STACK_PACKET_BUFFER_HEAP_SIZE;
+static uint16_t packet_buffer_bytes_used;
+
+static uint16_t radio_messages_per_s;
+static uint64_t radio_busy_until_us;
+
+uint8_t host_stack_source_route[2 + 2 * SL_ZIGBEE_MAX_SOURCE_ROUTE_RELAY_COUNT];
+uint8_t host_stack_source_route_length;
+
+sl_i2cspm_t *sl_i2cspm_inst;
+
+DWT_Type host_dwt;
+DCB_Type host_dcb;
+
+void host_stack_reset(void)
+{
+    for (uint16_t i = 0; i < HOST_STACK_ROUTE_TABLE_SIZE; i++) {
+        sli_zigbee_route_table[i] = (sli_zigbee_route_table_entry_t){
+            .destination = SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID,
+            .status = 3,  // Unused
+        };
+    }
+
+    for (uint16_t i = 0; i < HOST_STACK_ADDRESS_TABLE_SIZE; i++) {
+        address_table_node_ids[i] = SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID;
+        memset(address_table_eui64s[i], 0, sizeof(address_table_eui64s[i]));
+        address_table_extended_timeouts[i] = false;
+    }
+
+    in_flight_count = 0;
+    packet_buffer_bytes_used = 0;
+    radio_busy_until_us = 0;
+    host_stack_source_route_length = 0;
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000) + ((uint64_t)now.tv_nsec / 1000);
+}
+
+// Completes the oldest in-flight unicast
+static void complete_oldest_send(void)
+{
+    InFlightMessage message = in_flight[0];
+
+    in_flight_count--;
+    memmove(&in_flight[0], &in_flight[1], in_flight_count * sizeof(in_flight[0]));
+    packet_buffer_bytes_used -= message.buffer_bytes;
+
+    // Every destination is treated as a neighbor that acknowledged the frame
+    sl_zigbee_counter_info_t info = { .data = 0, .other_fields = &message.destination };
+    xncp_common_counter_cb(SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_SUCCESS, info);
+
+    xncp_common_message_sent_cb(SL_STATUS_OK, SL_ZIGBEE_OUTGOING_DIRECT,
+                                message.destination, &message.aps_frame,
+                                message.message_tag, 0, NULL);
+}
+
+void host_stack_complete_sends(void)
+{
+    while (in_flight_count > 0) {
+        complete_oldest_send();
+    }
+}
+
+void host_stack_set_radio_rate(uint16_t messages_per_s)
+{
+    radio_messages_per_s = messages_per_s;
+    radio_busy_until_us = now_us();
+}
+
+void host_stack_set_packet_buffer_heap_size(uint16_t bytes)
+{
+    packet_buffer_heap_size = bytes;
+}
+
+void host_stack_process(void)
+{
+    if (radio_messages_per_s == 0) {
+        return;
+    }
+
+    uint64_t now = now_us();
+    uint64_t airtime_us = 1000000 / radio_messages_per_s;
+
+    // An idle radio does not bank airtime
+    if ((in_flight_count == 0) || (radio_busy_until_us > now)) {
+        if (radio_busy_until_us < now) {
+            radio_busy_until_us = now;
+        }
+        return;
+    }
+
+    while ((in_flight_count > 0) && ((radio_busy_until_us + airtime_us) <= now)) {
+        radio_busy_until_us += airtime_us;
+        complete_oldest_send();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Stack API
+//------------------------------------------------------------------------------
+
+uint16_t sl_zigbee_get_pseudo_random_number(void)
+{
+    static uint32_t state = 0x12345678;
+
+    // xorshift32, deterministic so replays are reproducible
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (uint16_t)state;
+}
+
+void sl_legacy_buffer_manager_append_to_linked_buffers(sli_buffer_manager_buffer_t buffer,
+                                                       uint8_t *contents,
+                                                       uint8_t length)
+{
+    (void)buffer;
+
+    if (length > sizeof(host_stack_source_route) - host_stack_source_route_length) {
+        length = sizeof(host_stack_source_route) - host_stack_source_route_length;
+    }
+
+    memcpy(host_stack_source_route + host_stack_source_route_length, contents, length);
+    host_stack_source_route_length += length;
+}
+
+static int address_table_find(const uint8_t *eui64)
+{
+    for (uint16_t i = 0; i < HOST_STACK_ADDRESS_TABLE_SIZE; i++) {
+        if ((address_table_node_ids[i] != SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID)
+            && (memcmp(address_table_eui64s[i], eui64, sizeof(sl_802154_long_addr_t)) == 0)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+sl_status_t sl_zigbee_get_extended_timeout(sl_802154_long_addr_t remote_eui64)
+{
+    int index = address_table_find(remote_eui64);
+
+    if ((index < 0) || !address_table_extended_timeouts[index]) {
+        return SL_STATUS_NOT_FOUND;
+    }
+
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_zigbee_set_extended_timeout(sl_802154_long_addr_t remote_eui64,
+                                           bool extended_timeout)
+{
+    return __wrap_sli_zigbee_stack_set_extended_timeout(remote_eui64, extended_timeout);
+}
+
+sl_status_t sl_zigbee_get_address_table_info(uint8_t address_table_index,
+                                             sl_802154_short_addr_t *node_id,
+                                             sl_802154_long_addr_t eui64)
+{
+    if (address_table_index >= HOST_STACK_ADDRESS_TABLE_SIZE) {
+        return SL_STATUS_INVALID_PARAMETER;
+    }
+
+    *node_id = address_table_node_ids[address_table_index];
+    memcpy(eui64, address_table_eui64s[address_table_index], sizeof(sl_802154_long_addr_t));
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_zigbee_set_address_table_info(uint8_t address_table_index,
+                                             sl_802154_long_addr_t eui64,
+                                             sl_802154_short_addr_t node_id)
+{
+    return __wrap_sli_zigbee_stack_set_address_table_info(address_table_index, eui64, node_id);
+}
+
+uint16_t sl_legacy_buffer_manager_buffer_bytes_used(void)
+{
+    return packet_buffer_bytes_used;
+}
+
+uint16_t sl_legacy_buffer_manager_buffer_bytes_remaining(void)
+{
+    return packet_buffer_heap_size - packet_buffer_bytes_used;
+}
+
+uint8_t sl_zigbee_get_source_route_table_filled_size(void)
+{
+    return 0;
+}
+
+uint8_t sl_zigbee_get_source_route_table_total_size(void)
+{
+    return HOST_STACK_SOURCE_ROUTE_TABLE_SIZE;
+}
+
+uint8_t sl_zigbee_neighbor_count(void)
+{
+    return 0;
+}
+
+sl_status_t sl_zigbee_get_neighbor(uint8_t index, sl_zigbee_neighbor_table_entry_t *value)
+{
+    (void)index;
+    (void)value;
+    return SL_STATUS_NOT_FOUND;
+}
+
+sl_status_t sl_zigbee_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                   uint16_t index_or_destination,
+                                   sl_zigbee_aps_frame_t *aps_frame,
+                                   uint16_t message_tag,
+                                   uint8_t message_length,
+                                   const uint8_t *message_contents,
+                                   uint8_t *aps_sequence)
+{
+    return __wrap_sli_zigbee_stack_send_unicast(type, index_or_destination, aps_frame, message_tag,
+                                                message_length, message_contents, aps_sequence);
+}
+
+
+//------------------------------------------------------------------------------
+// Platform
+//------------------------------------------------------------------------------
+
+static uint64_t clock_offset_ms;
+
+void host_stack_advance_clock(uint32_t ms)
+{
+    clock_offset_ms += ms;
+}
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000) + ((uint64_t)now.tv_nsec / 1000000) + clock_offset_ms;
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+    // Ticks are already milliseconds
+    *ms = tick;
+    return SL_STATUS_OK;
+}
+
+uint32_t SystemCoreClockGet(void)
+{
+    return 1000000000;
+}
+
+//------------------------------------------------------------------------------
+// XNCP plugin
+//------------------------------------------------------------------------------
+
+uint64_t host_stack_notification_count;
+
+sl_status_t sl_zigbee_af_xncp_send_custom_ezsp_message(uint8_t length, uint8_t *payload)
+{
+    // Notifications are counted, not delivered anywhere
+    (void)length;
+    (void)payload;
+    host_stack_notification_count++;
+    return SL_STATUS_OK;
+}
+
+//------------------------------------------------------------------------------
+// ZBT-2 peripherals
+//------------------------------------------------------------------------------
+
+void led_manager_set_color(led_priority_t priority, rgb_t color)
+{
+    (void)priority;
+    (void)color;
+}
+
+bool led_manager_set_pixels(led_priority_t priority, uint8_t first, const rgb_t *colors, uint8_t count)
+{
+    (void)priority;
+    (void)colors;
+    return (first < WS2812_NUM_LEDS) && (count <= WS2812_NUM_LEDS - first);
+}
+
+uint8_t led_manager_get_pixel_count(void)
+{
+    return WS2812_NUM_LEDS;
+}
+
+bool led_manager_play_animation(led_priority_t priority,
+                                const led_keyframe_t *steps,
+                                uint8_t step_count,
+                                led_animation_done_t on_done)
+{
+    (void)priority;
+    (void)on_done;
+    return led_animation_validate(steps, step_count);
+}
+
+void led_manager_clear_pattern(led_priority_t priority)
+{
+    (void)priority;
+}
+
+bool led_effects_is_tilted(void)
+{
+    return false;
+}
+
+void qma6100p_read_acc_xyz(sl_i2cspm_t *i2cspm, float accdata[3])
+{
+    (void)i2cspm;
+    accdata[0] = 0.0f;
+    accdata[1] = 0.0f;
+    accdata[2] = 9.80665f;
+}
+
+//------------------------------------------------------------------------------
+// Linker wrapped stack functions
+//------------------------------------------------------------------------------
+
+bool __real_sli_zigbee_am_multicast_member(uint16_t multicast_id)
+{
+    // The multicast table is always empty
+    (void)multicast_id;
+    return false;
+}
+
+void __real_sli_zigbee_stack_incoming_message_handler(sl_zigbee_incoming_message_type_t type,
+                                                       sl_zigbee_aps_frame_t *apsFrame,
+                                                       sl_zigbee_rx_packet_info_t *packetInfo,
+                                                       uint8_t messageLength,
+                                                       uint8_t *message)
+{
+    // There is no host to forward to
+    (void)type;
+    (void)apsFrame;
+    (void)packetInfo;
+    (void)messageLength;
+    (void)message;
+}
+
+sl_status_t __real_sli_zigbee_stack_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                                 uint16_t index_or_destination,
+                                                 sl_zigbee_aps_frame_t *aps_frame,
+                                                 uint16_t message_tag,
+                                                 uint8_t message_length,
+                                                 const uint8_t *message_contents,
+                                                 uint8_t *aps_sequence)
+{
+    (void)type;
+    (void)message_contents;
+
+    if (in_flight_count == HOST_STACK_APS_UNICAST_MESSAGE_COUNT) {
+        return SL_STATUS_ZIGBEE_MAX_MESSAGE_LIMIT_REACHED;
+    }
+
+    uint16_t buffer_bytes = HOST_STACK_PACKET_BUFFER_OVERHEAD + message_length;
+
+    if ((packet_buffer_heap_size - packet_buffer_bytes_used) < buffer_bytes) {
+        xncp_common_counter_cb(SL_ZIGBEE_COUNTER_ALLOCATE_PACKET_BUFFER_FAILURE,
+                               (sl_zigbee_counter_info_t){ 0 });
+        return SL_STATUS_ALLOCATION_FAILED;
+    }
+
+    // The stack asks for a source route while building the network header
+    sli_buffer_manager_buffer_t header = 0;
+    bool consumed = false;
+    host_stack_source_route_length = 0;
+    nc_zigbee_override_append_source_route(index_or_destination, &header, &consumed);
+
+    aps_frame->sequence = next_aps_sequence++;
+    *aps_sequence = aps_frame->sequence;
+
+    in_flight[in_flight_count++] = (InFlightMessage){
+        .destination = index_or_destination,
+        .aps_frame = *aps_frame,
+        .message_tag = message_tag,
+        .buffer_bytes = buffer_bytes,
+    };
+    packet_buffer_bytes_used += buffer_bytes;
+
+    return SL_STATUS_OK;
+}
+
+sl_status_t __real_sli_zigbee_stack_set_extended_timeout(sl_802154_long_addr_t remote_eui64,
+                                                         bool extended_timeout)
+{
+    int index = address_table_find(remote_eui64);
+
+    if (index < 0) {
+        return SL_STATUS_NOT_FOUND;
+    }
+
+    address_table_extended_timeouts[index] = extended_timeout;
+    return SL_STATUS_OK;
+}
+
+sl_status_t __real_sli_zigbee_stack_set_address_table_info(uint8_t address_table_index,
+                                                           sl_802154_long_addr_t eui64,
+                                                           sl_802154_short_addr_t node_id)
+{
+    if (address_table_index >= HOST_STACK_ADDRESS_TABLE_SIZE) {
+        return SL_STATUS_INVALID_PARAMETER;
+    }
+
+    address_table_node_ids[address_table_index] = node_id;
+    memcpy(address_table_eui64s[address_table_index], eui64, sizeof(sl_802154_long_addr_t));
+    address_table_extended_timeouts[address_table_index] = false;
+    return SL_STATUS_OK;
+}
@@ -0,0 +1,51 @@
+/*
+ * host_stack.h
+ *
+ * Minimal in-memory stand-in for the EmberZNet stack, used by the host build
+ */
+
+#ifndef HOST_STACK_H
+#define HOST_STACK_H
+
+#include <stdint.h>
+
+#include "stack/include/sl_zigbee.h"
+
+#define HOST_STACK_ROUTE_TABLE_SIZE   SL_ZIGBEE_ROUTE_TABLE_SIZE
+#define HOST_STACK_ADDRESS_TABLE_SIZE 128
+#define HOST_STACK_SOURCE_ROUTE_TABLE_SIZE 254
+#define HOST_STACK_BROADCAST_TABLE_SIZE 64
+
+// Number of unicasts that can be in flight, mirrors SL_ZIGBEE_APS_UNICAST_MESSAGE_COUNT
+#define HOST_STACK_APS_UNICAST_MESSAGE_COUNT 128
+
+// Default packet buffer heap, every in-flight unicast holds its payload plus a fixed
+// overhead until it completes
+#define HOST_STACK_PACKET_BUFFER_HEAP_SIZE     8192
+#define HOST_STACK_PACKET_BUFFER_OVERHEAD      48
+
+// Clears every table and drops all in-flight messages
+void host_stack_reset(void);
+
+// Completes every in-flight unicast with SL_STATUS_OK, as the stack would once the
+// messages have been acknowledged
+void host_stack_complete_sends(void);
+
+// Simulated radio for loopback runs: in-flight unicasts complete in order, one every
+// 1/messages_per_s seconds, whenever host_stack_process() is called. 0 (the default)
+// leaves completion to host_stack_complete_sends().
+void host_stack_set_radio_rate(uint16_t messages_per_s);
+void host_stack_set_packet_buffer_heap_size(uint16_t bytes);
+void host_stack_process(void);
+
+// Moves the sleeptimer clock forward, for checks of timeouts measured in seconds
+void host_stack_advance_clock(uint32_t ms);
+
+// Bytes appended to the last outgoing frame header by the source route callback
+extern uint8_t host_stack_source_route[2 + 2 * SL_ZIGBEE_MAX_SOURCE_ROUTE_RELAY_COUNT];
+extern uint8_t host_stack_source_route_length;
+
+// Notifications sent to the host through the XNCP plugin
+extern uint64_t host_stack_notification_count;
+
+#endif // HOST_STACK_H
@@ -0,0 +1,11 @@
+// Host stub of the legacy packet buffer manager API used by the XNCP extensions
+
+#ifndef BUFFER_MANAGEMENT_H
+#define BUFFER_MANAGEMENT_H
+
+#include <stdint.h>
+
+uint16_t sl_legacy_buffer_manager_buffer_bytes_used(void);
+uint16_t sl_legacy_buffer_manager_buffer_bytes_remaining(void);
+
+#endif // BUFFER_MANAGEMENT_H
@@ -0,0 +1,12 @@
+// Host stub of the EMLIB critical sections, the host build is single threaded
+
+#ifndef EM_CORE_H
+#define EM_CORE_H
+
+#define CORE_DECLARE_IRQ_STATE
+#define CORE_ENTER_CRITICAL()
+#define CORE_EXIT_CRITICAL()
+#define CORE_ENTER_ATOMIC()
+#define CORE_EXIT_ATOMIC()
+
+#endif // EM_CORE_H
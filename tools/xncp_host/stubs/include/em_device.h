@@ -0,0 +1,28 @@
+// Host stub of the CMSIS core registers used by the XNCP extensions
+
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} DCB_Type;
+
+extern DWT_Type host_dwt;
+extern DCB_Type host_dcb;
+
+#define DWT (&host_dwt)
+#define DCB (&host_dcb)
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define DCB_DEMCR_TRCENA_Msk   (1UL << 24)
+
+uint32_t SystemCoreClockGet(void);
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,14 @@
+// Host stub of the device and USART definitions used by the XNCP extensions
+
+#ifndef EM_USART_H
+#define EM_USART_H
+
+#define usartHwFlowControlNone       0
+#define usartHwFlowControlCtsAndRts  3
+
+#define SL_IOSTREAM_USART_VCOM_FLOW_CONTROL_TYPE usartHwFlowControlNone
+
+#define RAM_MEM_SIZE 0x40000
+#define PART_NUMBER  "HOST"
+
+#endif // EM_USART_H
@@ -0,0 +1,9 @@
+// Host stub of the EZSP enums used by the XNCP extensions
+
+#ifndef EZSP_ENUM_H
+#define EZSP_ENUM_H
+
+#define SL_ZIGBEE_EZSP_MFG_STRING     0x01
+#define SL_ZIGBEE_EZSP_MFG_BOARD_NAME 0x02
+
+#endif // EZSP_ENUM_H
@@ -0,0 +1,8 @@
+// Host stub of the I2CSPM driver types
+
+#ifndef SL_I2CSPM_H
+#define SL_I2CSPM_H
+
+typedef struct sl_i2cspm sl_i2cspm_t;
+
+#endif // SL_I2CSPM_H
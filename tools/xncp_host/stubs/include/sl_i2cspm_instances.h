@@ -0,0 +1,10 @@
+// Host stub of the generated I2CSPM instances
+
+#ifndef SL_I2CSPM_INSTANCES_H
+#define SL_I2CSPM_INSTANCES_H
+
+#include "sl_i2cspm.h"
+
+extern sl_i2cspm_t *sl_i2cspm_inst;
+
+#endif // SL_I2CSPM_INSTANCES_H
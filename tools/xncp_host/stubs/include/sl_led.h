@@ -0,0 +1,26 @@
+// Host stub of the LED driver types
+
+#ifndef SL_LED_H
+#define SL_LED_H
+
+#include "sl_status.h"
+
+typedef uint8_t sl_led_state_t;
+
+#define SL_LED_CURRENT_STATE_OFF 0U
+#define SL_LED_CURRENT_STATE_ON  1U
+
+typedef struct {
+    void *context;
+    sl_status_t (*init)(void *context);
+    void (*turn_on)(void *context);
+    void (*turn_off)(void *context);
+    void (*toggle)(void *context);
+    sl_led_state_t (*get_state)(void *context);
+} sl_led_t;
+
+sl_status_t sl_led_init(const sl_led_t *led_handle);
+void sl_led_turn_on(const sl_led_t *led_handle);
+void sl_led_turn_off(const sl_led_t *led_handle);
+
+#endif // SL_LED_H
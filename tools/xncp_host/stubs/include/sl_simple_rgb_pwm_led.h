@@ -0,0 +1,18 @@
+// Host stub of the RGB PWM LED driver types
+
+#ifndef SL_SIMPLE_RGB_PWM_LED_H
+#define SL_SIMPLE_RGB_PWM_LED_H
+
+#include <stdint.h>
+
+#include "sl_led.h"
+
+typedef struct sl_led_rgb_pwm {
+    sl_led_t led_common;
+    void (*set_rgb_color)(void *context, uint16_t red, uint16_t green, uint16_t blue);
+    void (*get_rgb_color)(void *context, uint16_t *red, uint16_t *green, uint16_t *blue);
+} sl_led_rgb_pwm_t;
+
+void sl_led_set_rgb_color(const sl_led_rgb_pwm_t *led_handle, uint16_t red, uint16_t green, uint16_t blue);
+
+#endif // SL_SIMPLE_RGB_PWM_LED_H
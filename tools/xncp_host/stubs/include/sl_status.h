@@ -0,0 +1,25 @@
+/*
+ * Host stub of the Gecko Platform status codes used by the XNCP extensions
+ */
+
+#ifndef SL_STATUS_H
+#define SL_STATUS_H
+
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                               0x0000
+#define SL_STATUS_FAIL                             0x0001
+#define SL_STATUS_INVALID_STATE                    0x0002
+#define SL_STATUS_NOT_FOUND                        0x000C
+#define SL_STATUS_NO_MORE_RESOURCE                 0x0019
+#define SL_STATUS_ALLOCATION_FAILED                0x0019
+#define SL_STATUS_FULL                             0x001B
+#define SL_STATUS_WOULD_OVERFLOW                   0x001C
+#define SL_STATUS_INVALID_PARAMETER                0x0021
+#define SL_STATUS_NETWORK_UP                       0x0090
+#define SL_STATUS_NETWORK_DOWN                     0x0091
+#define SL_STATUS_ZIGBEE_MAX_MESSAGE_LIMIT_REACHED 0x0C0B
+
+#endif // SL_STATUS_H
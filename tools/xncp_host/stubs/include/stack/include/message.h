@@ -0,0 +1 @@
+// Host stub: everything the XNCP extensions need is declared in sl_zigbee.h
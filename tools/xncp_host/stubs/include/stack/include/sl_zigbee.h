@@ -0,0 +1,124 @@
+/*
+ * Host stub of the Simplicity SDK Zigbee stack API, limited to what the XNCP
+ * extensions use. Values match the SDK where the host protocol depends on them.
+ */
+
+#ifndef SL_ZIGBEE_H
+#define SL_ZIGBEE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sl_status.h"
+
+typedef uint16_t sl_802154_short_addr_t;
+typedef uint8_t sl_802154_long_addr_t[8];
+typedef uint16_t sl_zigbee_multicast_id_t;
+typedef uint8_t sli_buffer_manager_buffer_t;
+
+typedef struct {
+    uint16_t profileId;
+    uint16_t clusterId;
+    uint8_t sourceEndpoint;
+    uint8_t destinationEndpoint;
+    uint16_t options;
+    uint16_t groupId;
+    uint8_t sequence;
+    uint8_t radius;
+} sl_zigbee_aps_frame_t;
+
+typedef struct {
+    uint16_t destination;
+    uint16_t nextHop;
+    uint8_t status;
+    uint8_t cost;
+    uint8_t networkIndex;
+    uint8_t age;
+} sli_zigbee_route_table_entry_t;
+
+typedef enum {
+    SL_ZIGBEE_OUTGOING_DIRECT,
+    SL_ZIGBEE_OUTGOING_VIA_ADDRESS_TABLE,
+    SL_ZIGBEE_OUTGOING_VIA_BINDING,
+    SL_ZIGBEE_OUTGOING_MULTICAST,
+    SL_ZIGBEE_OUTGOING_MULTICAST_WITH_ALIAS,
+    SL_ZIGBEE_OUTGOING_BROADCAST_WITH_ALIAS,
+    SL_ZIGBEE_OUTGOING_BROADCAST
+} sl_zigbee_outgoing_message_type_t;
+
+typedef enum {
+    SL_ZIGBEE_INCOMING_UNICAST,
+    SL_ZIGBEE_INCOMING_UNICAST_REPLY,
+    SL_ZIGBEE_INCOMING_MULTICAST,
+    SL_ZIGBEE_INCOMING_MULTICAST_LOOPBACK,
+    SL_ZIGBEE_INCOMING_BROADCAST,
+    SL_ZIGBEE_INCOMING_BROADCAST_LOOPBACK
+} sl_zigbee_incoming_message_type_t;
+
+typedef struct {
+    sl_802154_short_addr_t sender_short_id;
+    sl_802154_long_addr_t sender_long_id;
+    uint8_t binding_index;
+    uint8_t address_index;
+    uint8_t last_hop_lqi;
+    int8_t last_hop_rssi;
+    uint32_t last_hop_timestamp;
+} sl_zigbee_rx_packet_info_t;
+
+typedef struct {
+    sl_802154_short_addr_t short_id;
+    uint8_t average_lqi;
+    uint8_t in_cost;
+    uint8_t out_cost;
+    uint8_t age;
+    uint32_t last_frame_counter;
+    sl_802154_long_addr_t long_id;
+} sl_zigbee_neighbor_table_entry_t;
+
+typedef enum {
+    SL_ZIGBEE_COUNTER_MAC_RX_BROADCAST = 0,
+    SL_ZIGBEE_COUNTER_MAC_TX_BROADCAST = 1,
+    SL_ZIGBEE_COUNTER_MAC_RX_UNICAST = 2,
+    SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_SUCCESS = 3,
+    SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_RETRY = 4,
+    SL_ZIGBEE_COUNTER_MAC_TX_UNICAST_FAILED = 5,
+    SL_ZIGBEE_COUNTER_ALLOCATE_PACKET_BUFFER_FAILURE = 6,
+    SL_ZIGBEE_COUNTER_BROADCAST_TABLE_FULL = 7
+} sl_zigbee_counter_type_t;
+
+typedef struct {
+    uint8_t data;
+    void *other_fields;
+} sl_zigbee_counter_info_t;
+
+#define SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID   0xFFFF
+#define SL_ZIGBEE_MAX_SOURCE_ROUTE_RELAY_COUNT 11
+
+uint16_t sl_zigbee_get_pseudo_random_number(void);
+void sl_legacy_buffer_manager_append_to_linked_buffers(sli_buffer_manager_buffer_t buffer,
+                                                       uint8_t *contents,
+                                                       uint8_t length);
+
+sl_status_t sl_zigbee_get_extended_timeout(sl_802154_long_addr_t remote_eui64);
+sl_status_t sl_zigbee_set_extended_timeout(sl_802154_long_addr_t remote_eui64,
+                                           bool extended_timeout);
+sl_status_t sl_zigbee_get_address_table_info(uint8_t address_table_index,
+                                             sl_802154_short_addr_t *node_id,
+                                             sl_802154_long_addr_t eui64);
+sl_status_t sl_zigbee_set_address_table_info(uint8_t address_table_index,
+                                             sl_802154_long_addr_t eui64,
+                                             sl_802154_short_addr_t node_id);
+
+uint8_t sl_zigbee_neighbor_count(void);
+sl_status_t sl_zigbee_get_neighbor(uint8_t index, sl_zigbee_neighbor_table_entry_t *value);
+
+sl_status_t sl_zigbee_send_unicast(sl_zigbee_outgoing_message_type_t type,
+                                   uint16_t index_or_destination,
+                                   sl_zigbee_aps_frame_t *aps_frame,
+                                   uint16_t message_tag,
+                                   uint8_t message_length,
+                                   const uint8_t *message_contents,
+                                   uint8_t *aps_sequence);
+
+#endif // SL_ZIGBEE_H
@@ -0,0 +1,11 @@
+// Host stub of the source route table API used by the XNCP extensions
+
+#ifndef SOURCE_ROUTE_H
+#define SOURCE_ROUTE_H
+
+#include <stdint.h>
+
+uint8_t sl_zigbee_get_source_route_table_filled_size(void);
+uint8_t sl_zigbee_get_source_route_table_total_size(void);
+
+#endif // SOURCE_ROUTE_H
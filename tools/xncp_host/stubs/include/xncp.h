@@ -0,0 +1,12 @@
+// Host stub of the XNCP plugin API
+
+#ifndef XNCP_H
+#define XNCP_H
+
+#include <stdint.h>
+
+#include "sl_status.h"
+
+sl_status_t sl_zigbee_af_xncp_send_custom_ezsp_message(uint8_t length, uint8_t *payload);
+
+#endif // XNCP_H
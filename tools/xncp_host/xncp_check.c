@@ -0,0 +1,620 @@
+/*
+ * xncp_check.c
+ *
+ * Runs XNCP frames against the host stack and checks the replies. Commands go through
+ * the custom frame callback, the same way the stack delivers host requests. Tables
+ * without a command of their own, such as the manual source routes and the address
+ * cache, are driven through their module API instead.
+ */
+
+#include "host_stack.h"
+#include "xncp_types.h"
+#include "xncp_config.h"
+#include "xncp_common_commands.h"
+#include "manual_source_route.h"
+#include "address_cache.h"
+#include "route_table_journal.h"
+#include "xncp_hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mirrors manual_source_route.c, to pick destinations that collide in the hash index
+#define ROUTE_HASH_SIZE (2 * XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE)
+
+#define ROUTE_STATUS_ACTIVE 0
+
+// Destinations the randomized source route check draws from
+#define MODEL_DESTINATIONS 1024
+
+// Route table entries that fit into one set_route_table_range frame
+#define RESTORE_ENTRIES_PER_FRAME 35
+
+// Provided by the XNCP core and common commands, normally called by the stack
+sl_status_t sl_zigbee_af_xncp_incoming_custom_frame_cb(uint8_t messageLength,
+                                                       uint8_t *messagePayload,
+                                                       uint8_t *replyPayloadLength,
+                                                       uint8_t *replyPayload);
+void xncp_common_init(uint8_t init_level);
+
+extern sli_zigbee_route_table_entry_t sli_zigbee_route_table[];
+
+static int failures;
+
+static uint8_t reply[XNCP_MAX_REPLY_LENGTH];
+static uint8_t reply_length;
+
+static void expect(const char *name, bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+// Sends a frame with the given command and payload, returns the reply status
+static uint8_t send_command(uint16_t command_id, const uint8_t *payload, uint8_t length)
+{
+    uint8_t frame[255] = { (uint8_t)command_id, (uint8_t)(command_id >> 8), 0 };
+
+    for (uint8_t i = 0; i < length; i++) {
+        frame[XNCP_HEADER_LENGTH + i] = payload[i];
+    }
+
+    reply_length = 0;
+    sl_zigbee_af_xncp_incoming_custom_frame_cb(XNCP_HEADER_LENGTH + length, frame,
+                                               &reply_length, reply);
+    return reply[2];
+}
+
+static uint16_t reply_u16(uint8_t offset)
+{
+    return (uint16_t)(reply[offset] | (reply[offset + 1] << 8));
+}
+
+static uint32_t reply_u32(uint8_t offset)
+{
+    return (uint32_t)reply_u16(offset) | ((uint32_t)reply_u16(offset + 2) << 16);
+}
+
+static void put_u16(uint8_t *buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t)(value >> 0);
+    buffer[1] = (uint8_t)(value >> 8);
+}
+
+//------------------------------------------------------------------------------
+// Dispatch
+//------------------------------------------------------------------------------
+
+// The send benchmark is turned on in config/xncp_core_config.h, like a firmware
+// project would, so this only passes if the dispatcher sees the option
+static void check_config_gated_commands(void)
+{
+    const char *name = "config gated commands";
+
+    send_command(XNCP_CMD_GET_SUPPORTED_FEATURES_REQ, NULL, 0);
+    expect(name, (reply_u32(XNCP_HEADER_LENGTH) & XNCP_FEATURE_SEND_BENCHMARK) != 0,
+           "send benchmark feature not advertised");
+
+    uint8_t status = send_command(XNCP_CMD_GET_SEND_BENCHMARK_RESULTS_REQ, NULL, 0);
+    expect(name, (status == SL_STATUS_OK)
+                 && (reply_u16(0) == (XNCP_CMD_GET_SEND_BENCHMARK_RESULTS_REQ | XNCP_CMD_RESPONSE_BIT)),
+           "send benchmark results command not dispatched");
+}
+
+//------------------------------------------------------------------------------
+// Multi-command framing
+//------------------------------------------------------------------------------
+
+// Appends a set_route_table_entry sub-command to `batch`, returns its length
+static uint8_t put_set_route_sub_command(uint8_t *batch, uint8_t index, uint16_t destination)
+{
+    put_u16(&batch[0], XNCP_CMD_SET_ROUTE_TABLE_ENTRY_REQ);
+    batch[2] = 7;
+    batch[3] = index;
+    put_u16(&batch[4], destination);
+    put_u16(&batch[6], 0x0001);
+    batch[8] = ROUTE_STATUS_ACTIVE;
+    batch[9] = 1;
+    return 10;
+}
+
+// Sends a batch whose first sub-command writes route table entry 0, then checks that
+// the batch is rejected and the entry left alone
+static void expect_batch_rejected(const char *name, const uint8_t *tail, uint8_t tail_length,
+                                  const char *what)
+{
+    uint8_t batch[64];
+    uint8_t length = put_set_route_sub_command(batch, 0, 0x1234);
+
+    memcpy(&batch[length], tail, tail_length);
+    length += tail_length;
+
+    host_stack_reset();
+    uint8_t status = send_command(XNCP_CMD_MULTI_COMMAND_REQ, batch, length);
+
+    expect(name, status == SL_STATUS_INVALID_PARAMETER, what);
+    expect(name, sli_zigbee_route_table[0].destination == SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID,
+           "sub-command of a rejected batch was executed");
+}
+
+static void check_multi_command_framing(void)
+{
+    const char *name = "multi-command framing";
+
+    // Command ID without its length byte
+    const uint8_t truncated_header[] = { 0x07, 0x00 };
+    expect_batch_rejected(name, truncated_header, sizeof(truncated_header),
+                          "truncated sub-command header accepted");
+
+    // Claims 7 payload bytes, carries 5
+    const uint8_t overrun[] = { 0x06, 0x00, 7, 1, 0x34, 0x12, 0x01, 0x00 };
+    expect_batch_rejected(name, overrun, sizeof(overrun), "sub-command length overrun accepted");
+
+    const uint8_t nested[] = { (uint8_t)XNCP_CMD_MULTI_COMMAND_REQ, 0x00, 0 };
+    expect_batch_rejected(name, nested, sizeof(nested), "nested multi-command accepted");
+
+    // A well formed batch runs in order: the read sees the preceding write
+    uint8_t batch[64];
+    uint8_t length = put_set_route_sub_command(batch, 2, 0x4321);
+    put_u16(&batch[length], XNCP_CMD_GET_ROUTE_TABLE_ENTRY_REQ);
+    batch[length + 2] = 1;
+    batch[length + 3] = 2;
+    length += 4;
+
+    host_stack_reset();
+    uint8_t status = send_command(XNCP_CMD_MULTI_COMMAND_REQ, batch, length);
+
+    // count(1) [status(1) length(1) reply]*, the read's reply starts after the write's
+    uint8_t read = XNCP_HEADER_LENGTH + 1 + 2;
+    expect(name, (status == SL_STATUS_OK) && (reply[XNCP_HEADER_LENGTH] == 2),
+           "well formed batch not executed");
+    expect(name, (reply[read] == SL_STATUS_OK) && (reply[read + 1] == 6)
+                 && (reply_u16(read + 2) == 0x4321),
+           "sub-command did not see the preceding write");
+}
+
+//------------------------------------------------------------------------------
+// Manual source routes
+//------------------------------------------------------------------------------
+
+// Returns the first destination after `after` whose home slot in the hash index is `slot`
+static xncp_node_id_t destination_with_home(uint16_t slot, xncp_node_id_t after)
+{
+    for (uint32_t destination = after + 1; destination < 0xFFF8; destination++) {
+        if (xncp_hash_u16((uint16_t)destination, ROUTE_HASH_SIZE) == slot) {
+            return (xncp_node_id_t)destination;
+        }
+    }
+
+    return 0xFFFF;
+}
+
+static void install_route(xncp_node_id_t destination, uint8_t num_relays, uint16_t ttl_s)
+{
+    uint8_t relay_bytes[2 * XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT];
+
+    for (uint8_t i = 0; i < num_relays; i++) {
+        put_u16(&relay_bytes[2 * i], (uint16_t)(0x1000 + i));
+    }
+
+    manual_source_route_install(destination, relay_bytes, num_relays, 0, ttl_s);
+}
+
+static void remove_route(xncp_node_id_t destination)
+{
+    ManualSourceRoute *route = manual_source_route_get(destination);
+
+    if (route != NULL) {
+        manual_source_route_remove(route);
+    }
+}
+
+static void expect_routes(const char *name, const xncp_node_id_t *destinations, uint8_t count,
+                          bool installed, const char *what)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if ((manual_source_route_get(destinations[i]) != NULL) != installed) {
+            printf("FAIL %s: %s (0x%04X)\n", name, what, destinations[i]);
+            failures++;
+        }
+    }
+}
+
+// Removing the head of a probe run has to pull the rest of the run back, including
+// entries displaced from a later home slot and runs that wrap around the index
+static void check_source_route_backward_shift(void)
+{
+    const char *name = "source route backward shift deletion";
+
+    manual_source_route_clear();
+
+    xncp_node_id_t a = destination_with_home(10, 0);
+    xncp_node_id_t b = destination_with_home(10, a);
+    xncp_node_id_t c = destination_with_home(10, b);
+    xncp_node_id_t d = destination_with_home(11, 0);
+
+    // Slots 10-13, `d` is displaced from its home slot by `b`
+    install_route(a, 1, 0);
+    install_route(b, 1, 0);
+    install_route(c, 1, 0);
+    install_route(d, 1, 0);
+
+    remove_route(a);
+    expect_routes(name, (xncp_node_id_t[]){ b, c, d }, 3, true, "route lost after deleting the run head");
+    expect_routes(name, &a, 1, false, "deleted route still found");
+
+    remove_route(c);
+    expect_routes(name, (xncp_node_id_t[]){ b, d }, 2, true, "route lost after deleting mid-run");
+
+    xncp_node_id_t e = destination_with_home(ROUTE_HASH_SIZE - 1, 0);
+    xncp_node_id_t f = destination_with_home(ROUTE_HASH_SIZE - 1, e);
+    xncp_node_id_t g = destination_with_home(0, 0);
+
+    // `f` wraps around to slot 0 and pushes `g` out of its home slot
+    install_route(e, 1, 0);
+    install_route(f, 1, 0);
+    install_route(g, 1, 0);
+
+    remove_route(e);
+    expect_routes(name, (xncp_node_id_t[]){ f, g }, 2, true, "route lost after deleting a wrapped run head");
+
+    // Random installs and removals over a small ID range, so probe runs collide often
+    static bool model[MODEL_DESTINATIONS];
+    uint16_t model_count = 0;
+    uint32_t seed = 1;
+
+    manual_source_route_clear();
+    memset(model, 0, sizeof(model));
+
+    for (uint32_t step = 0; step < 20000; step++) {
+        seed = seed * 1103515245 + 12345;
+        xncp_node_id_t destination = (xncp_node_id_t)((seed >> 16) % MODEL_DESTINATIONS);
+
+        if (model[destination]) {
+            remove_route(destination);
+            model[destination] = false;
+            model_count--;
+        } else if (model_count < XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE) {
+            install_route(destination, 0, 0);
+            model[destination] = true;
+            model_count++;
+        }
+
+        if ((step % 64) != 0) {
+            continue;
+        }
+
+        for (uint16_t i = 0; i < MODEL_DESTINATIONS; i++) {
+            if ((manual_source_route_get(i) != NULL) != model[i]) {
+                printf("FAIL %s: route 0x%04X %s after %u operations\n", name, i,
+                       model[i] ? "lost" : "resurrected", step + 1);
+                failures++;
+                return;
+            }
+        }
+    }
+}
+
+static void check_source_route_lru_eviction(void)
+{
+    const char *name = "source route LRU eviction";
+    const uint16_t size = XNCP_MANUAL_SOURCE_ROUTE_TABLE_SIZE;
+
+    // Full table: a route that was used survives, the least recently used one goes
+    manual_source_route_clear();
+
+    for (uint16_t i = 1; i <= size; i++) {
+        install_route(i, 0, 0);
+    }
+
+    manual_source_route_use(manual_source_route_get(1));
+    install_route(size + 1, 0, 0);
+
+    expect_routes(name, (xncp_node_id_t[]){ 1, 3, size, size + 1 }, 4, true,
+                  "route evicted out of LRU order");
+    expect_routes(name, (xncp_node_id_t[]){ 2 }, 1, false, "least recently used route kept");
+
+    // Full relay pool: as many routes are evicted as it takes to free enough chunks
+    manual_source_route_clear();
+
+    uint16_t two_chunk_routes = XNCP_MANUAL_SOURCE_ROUTE_RELAY_POOL_SIZE / 2;
+
+    for (uint16_t i = 1; i <= two_chunk_routes; i++) {
+        install_route(i, 6, 0);
+    }
+
+    install_route(0x8000, 3, 0);
+    expect_routes(name, (xncp_node_id_t[]){ 1 }, 1, false, "relay pool full, but nothing evicted");
+    expect_routes(name, (xncp_node_id_t[]){ 2, 0x8000 }, 2, true, "too many routes evicted");
+
+    // Needs four chunks, one is free
+    install_route(0x8001, XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT, 0);
+    expect_routes(name, (xncp_node_id_t[]){ 2, 3 }, 2, false, "relay pool full, but nothing evicted");
+    expect_routes(name, (xncp_node_id_t[]){ 4, 0x8000, 0x8001 }, 3, true, "too many routes evicted");
+
+    // Relays come back in over-the-air order, the reverse of the install order
+    uint16_t relays[XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT];
+    ManualSourceRoute *route = manual_source_route_get(0x8001);
+    bool ordered = (route != NULL)
+                   && (manual_source_route_get_relays(route, relays) == XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT);
+
+    for (uint8_t i = 0; ordered && (i < XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT); i++) {
+        ordered = (relays[i] == 0x1000 + XNCP_MAX_SOURCE_ROUTE_RELAY_COUNT - 1 - i);
+    }
+
+    expect(name, ordered, "relays spanning several chunks corrupted");
+}
+
+// The clock is real, so a second can tick over between two steps
+static bool ttl_near(xncp_node_id_t destination, uint16_t expected_s)
+{
+    ManualSourceRoute *route = manual_source_route_get(destination);
+
+    if (route == NULL) {
+        return false;
+    }
+
+    uint16_t ttl = manual_source_route_get_ttl(route);
+    return (ttl <= expected_s) && (ttl + 1 >= expected_s);
+}
+
+static void check_source_route_expiry(void)
+{
+    const char *name = "source route expiry";
+
+    manual_source_route_clear();
+
+    install_route(1, 0, 10);
+    expect(name, ttl_near(1, 10), "wrong TTL after install");
+
+    host_stack_advance_clock(11 * 1000);
+    expect(name, manual_source_route_get(1) == NULL, "route kept past its TTL");
+
+    // Installing 3 with the epoch 30000 s behind needs more than 16 bits, so the epoch
+    // moves up: 1 has already expired and is dropped, 2 keeps its remaining time
+    manual_source_route_clear();
+    install_route(1, 0, 100);
+    install_route(2, 0, 40000);
+    host_stack_advance_clock(30000 * 1000);
+    install_route(3, 0, 40000);
+
+    expect(name, ttl_near(2, 10000), "remaining TTL lost when rebasing");
+    expect(name, ttl_near(3, 40000), "wrong TTL after rebasing");
+    expect(name, manual_source_route_get(1) == NULL, "expired route kept when rebasing");
+
+    host_stack_advance_clock(10001 * 1000);
+    expect(name, manual_source_route_get(2) == NULL, "rebased route kept past its TTL");
+    expect(name, ttl_near(3, 29999), "wrong TTL after the rebased route expired");
+}
+
+//------------------------------------------------------------------------------
+// Route table journal
+//------------------------------------------------------------------------------
+
+// flags(1) epoch(2) latest_sequence(4) first_sequence(4) count(1), then the changes
+#define CHANGES_FLAGS  (XNCP_HEADER_LENGTH + 0)
+#define CHANGES_EPOCH  (XNCP_HEADER_LENGTH + 1)
+#define CHANGES_LATEST (XNCP_HEADER_LENGTH + 3)
+#define CHANGES_FIRST  (XNCP_HEADER_LENGTH + 7)
+#define CHANGES_COUNT  (XNCP_HEADER_LENGTH + 11)
+#define CHANGES_FIRST_CHANGE (XNCP_HEADER_LENGTH + 12)
+
+#define JOURNAL_FLAG_OVERFLOW (1 << 0)
+
+static uint8_t get_route_table_changes(uint32_t since)
+{
+    uint8_t payload[4] = {
+        (uint8_t)(since >> 0), (uint8_t)(since >> 8), (uint8_t)(since >> 16), (uint8_t)(since >> 24)
+    };
+
+    return send_command(XNCP_CMD_GET_ROUTE_TABLE_CHANGES_REQ, payload, sizeof(payload));
+}
+
+// A change made by the stack, which does not tell anyone
+static void stack_set_route(uint8_t index, uint16_t destination, uint16_t next_hop)
+{
+    sli_zigbee_route_table[index].destination = destination;
+    sli_zigbee_route_table[index].nextHop = next_hop;
+    sli_zigbee_route_table[index].status = ROUTE_STATUS_ACTIVE;
+    sli_zigbee_route_table[index].cost = 1;
+}
+
+static void host_set_route(uint8_t index, uint16_t destination, uint16_t next_hop)
+{
+    uint8_t payload[7] = { index, 0, 0, 0, 0, ROUTE_STATUS_ACTIVE, 1 };
+
+    put_u16(&payload[1], destination);
+    put_u16(&payload[3], next_hop);
+    send_command(XNCP_CMD_SET_ROUTE_TABLE_ENTRY_REQ, payload, sizeof(payload));
+}
+
+static void expect_changes(const char *name, uint32_t since, bool overflow, uint32_t latest,
+                           uint8_t count, const char *what)
+{
+    uint8_t status = get_route_table_changes(since);
+
+    bool ok = (status == SL_STATUS_OK)
+              && (((reply[CHANGES_FLAGS] & JOURNAL_FLAG_OVERFLOW) != 0) == overflow)
+              && (reply_u32(CHANGES_LATEST) == latest)
+              && (reply[CHANGES_COUNT] == count);
+
+    if (!ok) {
+        printf("FAIL %s: %s (flags %u, latest %u, count %u)\n", name, what, reply[CHANGES_FLAGS],
+               reply_u32(CHANGES_LATEST), reply[CHANGES_COUNT]);
+        failures++;
+    }
+}
+
+static void check_route_table_journal(void)
+{
+    const char *name = "route table journal";
+
+    host_stack_reset();
+    route_table_journal_init();
+
+    expect_changes(name, 0, false, 0, 0, "changes reported for an untouched table");
+    uint16_t epoch = reply_u16(CHANGES_EPOCH);
+
+    stack_set_route(3, 0x1234, 0x0001);
+    expect_changes(name, 0, false, 1, 1, "stack change not journaled");
+    expect(name, (reply[CHANGES_FIRST_CHANGE] == 3)
+                 && (reply_u16(CHANGES_FIRST_CHANGE + 1) == 0x1234)
+                 && (reply_u16(CHANGES_FIRST_CHANGE + 5) == 0x0001),
+           "journaled change does not match the entry");
+
+    // Host writes are not journaled, but a stack change made to the same entry before
+    // the write still is
+    host_set_route(4, 0x5678, 0x0002);
+    expect_changes(name, 1, false, 1, 0, "host write journaled");
+
+    stack_set_route(5, 0x9ABC, 0x0003);
+    host_set_route(5, 0x9ABC, 0x0004);
+    expect_changes(name, 1, false, 2, 1, "stack change lost behind a host write");
+    expect(name, reply_u16(CHANGES_FIRST_CHANGE + 5) == 0x0003, "host write journaled over a stack change");
+
+    // A restore larger than the journal does not overflow it
+    for (uint16_t first = 0; first <= XNCP_ROUTE_TABLE_JOURNAL_SIZE; first += RESTORE_ENTRIES_PER_FRAME) {
+        uint8_t restore[RESTORE_ENTRIES_PER_FRAME * 7];
+
+        for (uint8_t i = 0; i < RESTORE_ENTRIES_PER_FRAME; i++) {
+            uint8_t *entry = &restore[7 * i];
+
+            entry[0] = (uint8_t)(10 + first + i);
+            put_u16(&entry[1], (uint16_t)(0x2000 + first + i));
+            put_u16(&entry[3], 0x0005);
+            entry[5] = ROUTE_STATUS_ACTIVE;
+            entry[6] = 1;
+        }
+
+        send_command(XNCP_CMD_SET_ROUTE_TABLE_RANGE_REQ, restore, sizeof(restore));
+    }
+
+    expect_changes(name, 2, false, 2, 0, "route table restore journaled");
+
+    // One more stack change than the journal holds
+    for (uint16_t i = 0; i <= XNCP_ROUTE_TABLE_JOURNAL_SIZE; i++) {
+        stack_set_route((uint8_t)(150 + i), (uint16_t)(0x3000 + i), 0x0006);
+    }
+
+    uint32_t latest = 2 + XNCP_ROUTE_TABLE_JOURNAL_SIZE + 1;
+
+    expect_changes(name, 2, true, latest, 0, "overflow not reported");
+    expect(name, reply_u32(CHANGES_FIRST) == latest + 1, "overflow does not skip to the latest sequence");
+
+    // The oldest change still held is returned without the overflow flag
+    uint8_t fits = (XNCP_MAX_REPLY_LENGTH - CHANGES_FIRST_CHANGE) / 9;
+    expect_changes(name, latest - XNCP_ROUTE_TABLE_JOURNAL_SIZE, false, latest, fits,
+                   "oldest journaled change not returned");
+
+    // Resyncing from the latest sequence, as the host does after reading the whole table
+    expect_changes(name, latest, false, latest, 0, "changes reported after a resync");
+    expect(name, reply_u16(CHANGES_EPOCH) == epoch, "epoch changed without a reboot");
+
+    // Sequence numbers from a previous boot
+    expect_changes(name, latest + 100, true, latest, 0, "sequence ahead of the journal accepted");
+}
+
+//------------------------------------------------------------------------------
+// Address cache
+//------------------------------------------------------------------------------
+
+static int address_table_index_of(const uint8_t *eui64)
+{
+    for (uint16_t i = 0; i < HOST_STACK_ADDRESS_TABLE_SIZE; i++) {
+        sl_802154_short_addr_t node_id;
+        sl_802154_long_addr_t entry_eui64;
+
+        sl_zigbee_get_address_table_info((uint8_t)i, &node_id, entry_eui64);
+
+        if ((node_id != SL_ZIGBEE_TABLE_ENTRY_UNUSED_NODE_ID) && (memcmp(entry_eui64, eui64, 8) == 0)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void expect_cache_stats(const char *name, uint32_t lookups, uint32_t hits, uint32_t inserts,
+                               const char *what)
+{
+    const AddressCacheStats *stats = address_cache_get_stats();
+
+    if ((stats->lookups != lookups) || (stats->hits != hits) || (stats->inserts != inserts)) {
+        printf("FAIL %s: %s (lookups %u, hits %u, inserts %u)\n", name, what,
+               stats->lookups, stats->hits, stats->inserts);
+        failures++;
+    }
+}
+
+static void check_address_cache(void)
+{
+    const char *name = "address cache";
+
+    uint8_t a[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t b[8] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+    uint8_t c[8] = { 9, 9, 9, 9, 9, 9, 9, 9 };
+
+    host_stack_reset();
+    address_cache_init();
+
+    address_cache_set_extended_timeout(a, 0x1111, true);
+    expect_cache_stats(name, 1, 0, 1, "first lookup not a miss");
+    expect(name, sl_zigbee_get_extended_timeout(a) == SL_STATUS_OK, "extended timeout not set on a miss");
+
+    address_cache_set_extended_timeout(a, 0x1111, true);
+    expect_cache_stats(name, 2, 1, 1, "repeated lookup not a hit");
+
+    // The host clears the flag over plain EZSP, the cache must notice
+    sl_zigbee_set_extended_timeout(a, false);
+    address_cache_set_extended_timeout(a, 0x1111, true);
+    expect_cache_stats(name, 3, 2, 1, "lookup after a host flag change not a hit");
+    expect(name, sl_zigbee_get_extended_timeout(a) == SL_STATUS_OK,
+           "stale cached flag kept after the host cleared it");
+
+    address_cache_set_extended_timeout(a, 0x1111, false);
+    expect(name, sl_zigbee_get_extended_timeout(a) == SL_STATUS_NOT_FOUND, "extended timeout not cleared on a hit");
+
+    // The host gives the entry to another node, the cached index must not be reused
+    int index = address_table_index_of(a);
+    expect(name, index >= 0, "no address table entry created");
+
+    sl_zigbee_set_address_table_info((uint8_t)index, b, 0x2222);
+    address_cache_set_extended_timeout(a, 0x1111, true);
+    expect_cache_stats(name, 5, 3, 2, "lookup after the host rewrote the entry not a miss");
+    expect(name, (address_table_index_of(a) >= 0) && (address_table_index_of(b) == index),
+           "cached index reused after the host rewrote the entry");
+
+    // An entry the host created is found in the table and cached without an insert
+    address_cache_set_extended_timeout(b, 0x2222, true);
+    address_cache_set_extended_timeout(b, 0x2222, true);
+    expect_cache_stats(name, 7, 4, 2, "host created entry not found or not cached");
+
+    // Nodes without an entry keep the default timeout without getting one
+    address_cache_set_extended_timeout(c, 0x3333, false);
+    expect_cache_stats(name, 8, 4, 2, "entry created to clear a flag");
+    expect(name, address_table_index_of(c) < 0, "entry created to clear a flag");
+}
+
+int main(void)
+{
+    host_stack_reset();
+    xncp_common_init(0);
+
+    check_config_gated_commands();
+    check_multi_command_framing();
+    check_source_route_backward_shift();
+    check_source_route_lru_eviction();
+    check_source_route_expiry();
+    check_route_table_journal();
+    check_address_cache();
+
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("XNCP checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/*
+ * xncp_loopback.c
+ *
+ * Runs the XNCP core against the host stack as a stand-in NCP, so host-side tools can
+ * be exercised without a radio.
+ *
+ * Requests are read from stdin and replies written to stdout, one frame per line as
+ * hex bytes, in the same format as the customFrame payloads in replay traces. While
+ * waiting for input the main loop keeps running: process actions are called and the
+ * simulated radio completes in-flight unicasts at a fixed rate.
+ */
+
+#include "host_stack.h"
+#include "xncp_types.h"
+#include "xncp_notify.h"
+#include "send_benchmark.h"
+#include "memory_stats.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_FRAME_LENGTH 255
+
+// Provided by the XNCP core and common commands, normally called by the stack
+sl_status_t sl_zigbee_af_xncp_incoming_custom_frame_cb(uint8_t messageLength,
+                                                       uint8_t *messagePayload,
+                                                       uint8_t *replyPayloadLength,
+                                                       uint8_t *replyPayload);
+void xncp_common_init(uint8_t init_level);
+
+static int hex_value(int c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    } else if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+// Returns the frame length, or -1 if the line is not a valid frame
+static int parse_frame(const char *line, uint8_t *frame)
+{
+    int length = 0;
+    int high_nibble = -1;
+
+    for (const char *p = line; *p != '\0'; p++) {
+        if ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) {
+            continue;
+        }
+
+        int nibble = hex_value(*p);
+
+        if ((nibble < 0) || ((high_nibble < 0) && (length == MAX_FRAME_LENGTH))) {
+            return -1;
+        }
+
+        if (high_nibble < 0) {
+            high_nibble = nibble;
+        } else {
+            frame[length++] = (uint8_t)((high_nibble << 4) | nibble);
+            high_nibble = -1;
+        }
+    }
+
+    return (high_nibble < 0) ? length : -1;
+}
+
+static void main_loop_pass(void)
+{
+    host_stack_process();
+    send_benchmark_process_action();
+    memory_stats_process_action();
+    xncp_notify_process_action();
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-r messages_per_s] [-H heap_bytes]\n"
+            "  -r  Rate at which the simulated radio completes unicasts (default: 250)\n"
+            "  -H  Packet buffer heap size in bytes (default: %d)\n",
+            name, HOST_STACK_PACKET_BUFFER_HEAP_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long radio_rate = 250;
+    unsigned long heap_size = HOST_STACK_PACKET_BUFFER_HEAP_SIZE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:H:")) != -1) {
+        switch (opt) {
+            case 'r':
+                radio_rate = strtoul(optarg, NULL, 0);
+                break;
+            case 'H':
+                heap_size = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if ((optind != argc) || (radio_rate == 0) || (radio_rate > UINT16_MAX)
+        || (heap_size > UINT16_MAX)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    host_stack_reset();
+    host_stack_set_radio_rate((uint16_t)radio_rate);
+    host_stack_set_packet_buffer_heap_size((uint16_t)heap_size);
+    xncp_common_init(0);
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    char line[4 * MAX_FRAME_LENGTH];
+    size_t line_length = 0;
+
+    for (;;) {
+        struct pollfd input = { .fd = STDIN_FILENO, .events = POLLIN };
+
+        // Wake up every millisecond to keep the main loop and the radio running
+        if (poll(&input, 1, 1) > 0) {
+            ssize_t count = read(STDIN_FILENO, line + line_length, sizeof(line) - line_length - 1);
+
+            if (count <= 0) {
+                return 0;
+            }
+
+            line_length += (size_t)count;
+            line[line_length] = '\0';
+
+            char *end;
+
+            while ((end = strchr(line, '\n')) != NULL) {
+                *end = '\0';
+
+                uint8_t request[MAX_FRAME_LENGTH];
+                uint8_t reply[MAX_FRAME_LENGTH];
+                uint8_t reply_length = 0;
+                int request_length = parse_frame(line, request);
+
+                if (request_length < 0) {
+                    printf("ERROR invalid frame\n");
+                } else if (request_length > 0) {
+                    sl_zigbee_af_xncp_incoming_custom_frame_cb((uint8_t)request_length, request,
+                                                               &reply_length, reply);
+
+                    for (uint8_t i = 0; i < reply_length; i++) {
+                        printf("%02X", reply[i]);
+                    }
+
+                    printf("\n");
+                }
+
+                line_length -= (size_t)(end + 1 - line);
+                memmove(line, end + 1, line_length + 1);
+            }
+
+            if (line_length == sizeof(line) - 1) {
+                // Overlong line, drop it
+                printf("ERROR invalid frame\n");
+                line_length = 0;
+            }
+        }
+
+        main_loop_pass();
+    }
+}
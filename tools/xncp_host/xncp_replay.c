@@ -0,0 +1,284 @@
+/*
+ * xncp_replay.c
+ *
+ * Replays recorded XNCP customFrame traces through the XNCP core on the host and
+ * reports throughput and per-command latency.
+ *
+ * A trace has one frame per line, written as hex bytes exactly as the host sends it in
+ * the EZSP customFrame payload (XNCP header included). Whitespace between bytes is
+ * ignored and `#` starts a comment.
+ */
+
+#include "host_stack.h"
+#include "xncp_types.h"
+#include "xncp_notify.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_FRAME_LENGTH    255
+#define MAX_TRACE_FRAMES    65536
+#define MAX_TRACKED_COMMANDS 64
+
+typedef struct {
+    uint8_t length;
+    uint8_t data[MAX_FRAME_LENGTH];
+} Frame;
+
+typedef struct {
+    uint16_t command_id;
+    uint64_t count;
+    uint64_t failures;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} CommandStats;
+
+// Provided by the XNCP core and common commands, normally called by the stack
+sl_status_t sl_zigbee_af_xncp_incoming_custom_frame_cb(uint8_t messageLength,
+                                                       uint8_t *messagePayload,
+                                                       uint8_t *replyPayloadLength,
+                                                       uint8_t *replyPayload);
+void xncp_common_init(uint8_t init_level);
+
+static Frame frames[MAX_TRACE_FRAMES];
+static size_t frame_count;
+
+static CommandStats command_stats[MAX_TRACKED_COMMANDS];
+static size_t command_stats_count;
+
+static int hex_value(int c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    } else if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+static bool load_trace(const char *path)
+{
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    char line[4 * MAX_FRAME_LENGTH];
+    unsigned line_number = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+
+        Frame frame = {0};
+        int high_nibble = -1;
+
+        for (char *p = line; *p != '\0'; p++) {
+            if ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) {
+                continue;
+            }
+
+            int nibble = hex_value(*p);
+
+            if ((nibble < 0) || ((high_nibble < 0) && (frame.length == MAX_FRAME_LENGTH))) {
+                fprintf(stderr, "%s:%u: invalid frame\n", path, line_number);
+                fclose(file);
+                return false;
+            }
+
+            if (high_nibble < 0) {
+                high_nibble = nibble;
+            } else {
+                frame.data[frame.length++] = (uint8_t)((high_nibble << 4) | nibble);
+                high_nibble = -1;
+            }
+        }
+
+        if (high_nibble >= 0) {
+            fprintf(stderr, "%s:%u: odd number of hex digits\n", path, line_number);
+            fclose(file);
+            return false;
+        }
+
+        if (frame.length == 0) {
+            continue;
+        }
+
+        if (frame_count == MAX_TRACE_FRAMES) {
+            fprintf(stderr, "%s: more than %d frames\n", path, MAX_TRACE_FRAMES);
+            fclose(file);
+            return false;
+        }
+
+        frames[frame_count++] = frame;
+    }
+
+    fclose(file);
+    return true;
+}
+
+static CommandStats* get_command_stats(uint16_t command_id)
+{
+    for (size_t i = 0; i < command_stats_count; i++) {
+        if (command_stats[i].command_id == command_id) {
+            return &command_stats[i];
+        }
+    }
+
+    if (command_stats_count == MAX_TRACKED_COMMANDS) {
+        return NULL;
+    }
+
+    command_stats[command_stats_count].command_id = command_id;
+    return &command_stats[command_stats_count++];
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+static int compare_command_stats(const void *a, const void *b)
+{
+    return (int)((const CommandStats *)a)->command_id - (int)((const CommandStats *)b)->command_id;
+}
+
+static void print_frame(const char *prefix, const uint8_t *data, uint8_t length)
+{
+    printf("%s", prefix);
+
+    for (uint8_t i = 0; i < length; i++) {
+        printf("%02X", data[i]);
+    }
+
+    printf("\n");
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-n iterations] [-v] trace...\n"
+            "  -n  Number of times to replay the traces (default: 1000)\n"
+            "  -v  Print every request and reply of the first iteration\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iterations = 1000;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:v")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if ((optind == argc) || (iterations == 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        if (!load_trace(argv[i])) {
+            return 1;
+        }
+    }
+
+    if (frame_count == 0) {
+        fprintf(stderr, "No frames to replay\n");
+        return 1;
+    }
+
+    host_stack_reset();
+    xncp_common_init(0);
+
+    uint64_t total_ns = 0;
+
+    for (unsigned long iteration = 0; iteration < iterations; iteration++) {
+        for (size_t i = 0; i < frame_count; i++) {
+            // Handlers may write to the request, replay a copy
+            Frame request = frames[i];
+            uint8_t reply[MAX_FRAME_LENGTH];
+            uint8_t reply_length = 0;
+
+            uint64_t start = now_ns();
+            sl_zigbee_af_xncp_incoming_custom_frame_cb(request.length, request.data,
+                                                       &reply_length, reply);
+            uint64_t elapsed = now_ns() - start;
+
+            total_ns += elapsed;
+
+            // Frames too short for a command ID are accounted as XNCP_CMD_UNKNOWN
+            uint16_t command_id = XNCP_CMD_UNKNOWN;
+            if (frames[i].length >= 2) {
+                command_id = (uint16_t)(frames[i].data[0] | (frames[i].data[1] << 8));
+            }
+
+            CommandStats *stats = get_command_stats(command_id);
+            if (stats != NULL) {
+                stats->count++;
+                stats->total_ns += elapsed;
+                stats->failures += (reply[2] != XNCP_STATUS_OK);
+
+                if (elapsed > stats->max_ns) {
+                    stats->max_ns = elapsed;
+                }
+            }
+
+            if (verbose && (iteration == 0)) {
+                print_frame("> ", frames[i].data, frames[i].length);
+                print_frame("< ", reply, reply_length);
+            }
+
+            // Let queued unicasts complete and run a main loop pass before the next
+            // frame, outside of the timing
+            host_stack_complete_sends();
+            xncp_notify_process_action();
+        }
+    }
+
+    uint64_t total_frames = (uint64_t)frame_count * iterations;
+
+    printf("%" PRIu64 " frames in %.3f ms, %.0f frames/s, %" PRIu64 " notifications\n\n",
+           total_frames, total_ns / 1e6, total_frames / (total_ns / 1e9),
+           host_stack_notification_count);
+
+    qsort(command_stats, command_stats_count, sizeof(command_stats[0]), compare_command_stats);
+
+    printf("command   count       failed      mean ns   max ns\n");
+    for (size_t i = 0; i < command_stats_count; i++) {
+        const CommandStats *stats = &command_stats[i];
+
+        printf("0x%04X    %-10" PRIu64 "  %-10" PRIu64 "  %-8.0f  %" PRIu64 "\n",
+               stats->command_id, stats->count, stats->failures,
+               (double)stats->total_ns / stats->count, stats->max_ns);
+    }
+
+    return 0;
+}